@@ -1,9 +1,15 @@
 #! /bin/sh
 
+# Packs each environment in src/ into export/<name>.sky. Maps are also
+# compiled to map.skymap, stored uncompressed so they're read without inflating;
+# point MAPCOMPILER at a built solemnsky_mapcompiler if it's not in PATH.
+# Packing needs 7z (p7zip); the game itself reads archives with zlib.
+
 mkdir -p export
 rm -rf export/*
 
 root=$PWD
+mapcompiler=${MAPCOMPILER:-solemnsky_mapcompiler}
 
 cd src/
 for map in *
@@ -13,6 +19,14 @@ do
   cd $root/src/$map
   7z a $root/export/$map.zip *
 
+  tmp=$(mktemp -d)
+  if $mapcompiler map.json $tmp/map.skymap; then
+    (cd $tmp && 7z a -mx0 $root/export/$map.zip map.skymap)
+  else
+    echo "** could not compile map for \"$map\", exporting json only **"
+  fi
+  rm -rf $tmp
+
   cd $root/export
   mv $map.zip $map.sky
 
@@ -57,10 +57,11 @@
                 openal
                 libsndfile
                 glew
-                p7zip
+                zlib
                 boost
                 sfml
               ]
+              ++ lib.optionals (!stdenv.isDarwin) [libGL]
               ++ lib.optionals (!stdenv.isDarwin) (with xorg; [
                 udev
                 libX11
@@ -69,6 +70,7 @@
                 xcbutilimage
               ])
               ++ lib.optionals stdenv.isDarwin (with pkgs.darwin.apple_sdk.frameworks; [
+                OpenGL
                 IOKit
                 Foundation
                 Carbon
@@ -81,12 +83,11 @@
               in ''
                 mv $out/bin/${binaryName} $out/bin/${unwrappedBinary}
                 makeWrapper $out/bin/${unwrappedBinary} $out/bin/${binaryName} \
-                  --set SOLEMNSKY_RESOURCES "${appResources}" \
-                  --set PATH "${p7zip}/bin"
+                  --set SOLEMNSKY_RESOURCES "${appResources}"
               '';
             in
               concatStringsSep "\n" (map wrapBinary
-                ["solemnsky_client" "solemnsky_server" "solemnsky_tests"]);
+                ["solemnsky_client" "solemnsky_server" "solemnsky_tests" "solemnsky_renderbench"]);
           };
     in {
       packages = genAttrs supportedSystems (system: with nixpkgs.legacyPackages.${system}; rec {
@@ -102,5 +103,13 @@
           cp ${everything}/bin/solemnsky_client $out/bin
         '';
       });
+
+      # environments/export.sh packs .sky files with 7z.
+      devShells = genAttrs supportedSystems (system: with nixpkgs.legacyPackages.${system}; {
+        default = mkShell {
+          inputsFrom = [self.packages.${system}.everything];
+          packages = [p7zip];
+        };
+      });
     };
 }
@@ -62,6 +62,16 @@ void Client::drawDebugLeft(Printer &p) {
   p.printLn("cycle:" + profilerSnap.cycleTime.print());
   p.printLn("logic:" + profilerSnap.logicTime.print());
   p.printLn("render:" + profilerSnap.renderTime.print());
+  p.printLn("prims/draws:" + printFloat(float(profilerSnap.primCount)) + "/"
+                + printFloat(float(profilerSnap.drawCalls)));
+  p.printLn("allocs/frame:" + printFloat(float(profilerSnap.allocations)));
+  p.setColor(255, 0, 0);
+  p.printLn("STAGES (p50/p95/p99):");
+  p.setColor(0, 0, 0);
+  for (size_t i = 0; i < profilerSnap.stageTimes.size(); ++i) {
+    p.printLn(showProfileStage(ProfileStage(i)) + ":"
+                  + profilerSnap.stageTimes[i].printPercentiles());
+  }
   p.breakLine();
   p.setColor(255, 0, 0);
   p.printLn("GAME INFO:");
@@ -70,6 +80,30 @@ void Client::drawDebugLeft(Printer &p) {
   p.breakLine();
 }
 
+void Client::drawFrameGraph(ui::Frame &f, const sf::Vector2f &pos) {
+  const auto &cycles = profilerSnap.recentCycles;
+  const float height = style.base.debugGraphHeight,
+      scale = height / style.base.debugGraphScale;
+  f.drawRect(pos, pos + sf::Vector2f(style.base.debugMargin, height),
+             style.base.debugBackground);
+  if (cycles.empty()) return;
+
+  const float barWidth = style.base.debugMargin / float(cycles.size());
+  const TimeDiff target = references.tickStep;
+  for (size_t i = 0; i < cycles.size(); ++i) {
+    const float barHeight = std::min(height, cycles[i] * scale);
+    const sf::Vector2f bottomLeft = pos + sf::Vector2f(i * barWidth, height);
+    f.drawRect(bottomLeft - sf::Vector2f(0, barHeight),
+               bottomLeft + sf::Vector2f(barWidth, 0),
+               cycles[i] > target * 1.5f ? style.base.debugGraphSlowColor
+                                         : style.base.debugGraphColor);
+  }
+
+  const float targetY = pos.y + height - std::min(height, target * scale);
+  f.drawRect({pos.x, targetY}, {pos.x + style.base.debugMargin, targetY + 1},
+             style.base.debugGraphTarget);
+}
+
 void Client::drawDebugRight(Printer &p) {
   p.setColor(255, 0, 0);
   p.printLn("MORE GAME INFO:");
@@ -182,6 +216,7 @@ void Client::renderGame(ui::Frame &f) {
       f.drawText(
           {20, 20}, [&](ui::TextFrame &tf) { drawDebugLeft(tf); },
           style.base.debugText, resources.defaultFont);
+      drawFrameGraph(f, {0, style.base.debugHeight});
       f.drawRect({1600, 0}, {1600 - style.base.debugMargin, style.base.debugHeight}, style.base.debugBackground);
       f.drawText(
           {1580, 20}, [&](ui::TextFrame &tf) { drawDebugRight(tf); },
@@ -210,9 +245,9 @@ Client::Client(const ui::AppRefs &references) :
                 style.menu.aboutButtonText),
 
     shared(*this, references),
-    homePage(std::make_unique<HomePage>(shared), sf::Transform()),
-    listingPage(std::make_unique<ListingPage>(shared), sf::Transform()),
-    settingsPage(std::make_unique<SettingsPage>(shared), sf::Transform()),
+    homePage(std::make_unique<HomePage>(shared), sf::Transform(), true),
+    listingPage(std::make_unique<ListingPage>(shared), sf::Transform(), true),
+    settingsPage(std::make_unique<SettingsPage>(shared), sf::Transform(), true),
     tryingToQuit(false),
     quitDisplayTimer(style.menu.quitDescriptionFade),
 
@@ -344,7 +379,7 @@ bool Client::handle(const sf::Event &event) {
 void Client::reset() {
   ui::Control::reset();
   if (game) game->reset();
-  referencePage(uiState.focusedPage).reset();
+  referencePageBase(uiState.focusedPage).reset();
 }
 
 void Client::signalRead() {
@@ -414,6 +449,7 @@ void Client::focusPage(const PageType page) {
     uiState.pageFocusing = true;
     uiState.focusedPage = page;
     referencePage(page).onFocus();
+    referencePageBase(page).invalidate();
   }
 }
 
@@ -421,6 +457,7 @@ void Client::blurPage() {
   referencePage(uiState.focusedPage).reset();
   backButton.reset();
   referencePage(uiState.focusedPage).onBlur();
+  referencePageBase(uiState.focusedPage).invalidate();
   uiState.pageFocusing = false;
 }
 
@@ -429,5 +466,7 @@ void Client::changeSettings(const ui::SettingsDelta &settingsDelta) {
   forAllPages([&](Page &page) {
     page.onChangeSettings(settingsDelta);
   });
+  for (auto base : {&homePage.base, &listingPage.base, &settingsPage.base})
+    base->invalidate();
   if (game) game->onChangeSettings(settingsDelta);
 }
@@ -67,6 +67,7 @@ private:
   // Render subroutines.
   void drawDebugLeft(Printer &p);
   void drawDebugRight(Printer &p);
+  void drawFrameGraph(ui::Frame &f, const sf::Vector2f &pos);
   void renderPage(ui::Frame &f, const PageType type,
                   const sf::Vector2f &offset, const std::string &name,
                   ui::TransformedBase &page);
@@ -56,10 +56,11 @@ struct ClientUiState {
  */
 struct ClientShared {
   friend class Client;
+  friend class RenderBench;
  private:
   Client &client;
 
-  // Constructed by client.
+  // Constructed by client (or by the render benchmark, around one).
   ClientShared(Client &client, const ui::AppRefs &references);
 
  public:
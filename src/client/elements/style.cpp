@@ -56,8 +56,13 @@ Style::Base::Base() :
     normalCheckbox(normalButton),
 
     debugMargin(380),
-    debugHeight(400),
-    debugBackground(255, 255, 255, 140) {
+    debugHeight(560),
+    debugBackground(255, 255, 255, 140),
+    debugGraphHeight(100),
+    debugGraphScale(1.0f / 20.0f),
+    debugGraphColor(0, 160, 0),
+    debugGraphSlowColor(200, 0, 0),
+    debugGraphTarget(0, 0, 0, 120) {
   normalCheckbox.dimensions = {50, 50};
 }
 
@@ -180,7 +185,7 @@ Style::Game::Game(const Style::Base &base) :
     playerJoinedColor(0, 255, 0),
 
     messageEntry(base.normalTextEntry),
-    messageLog(700, 800, 300, 10, 9, base.normalFontSize),
+    messageLog(700, 800, 300, 10, 9, base.normalFontSize, 500),
 
     messageLogText(base.normalText),
     playerListText(base.normalText) {
@@ -191,14 +196,33 @@ Style::SkyRender::SkyRender() :
     rollAmount(25),
     rollSpeed(2),
     flipSpeed(2),
-    afterburnArea(-70, -10, 70, 20),
     barArea(-100, -100, 200, 30),
     throttleStall(0, 0, 0, 100),
     throttle(sf::Color::Black),
     health(sf::Color::Green),
     energy(sf::Color::Blue),
     deathRate(0.5),
-    planeGraphicsScale(1.5) { }
+    planeGraphicsScale(1.5),
+    obstacleFill(sf::Color::Transparent),
+    obstacleOutline(sf::Color::White),
+    obstacleOutlineThickness(1),
+    cullMargin(150),
+    particleCapacity(8192),
+    afterburnRate(120),
+    trailRate(20),
+    afterburnParticles(0.3, 150, 15, 2, 8, 3,
+                       sf::Color(255, 220, 80, 255), sf::Color(255, 40, 0, 0)),
+    trailParticles(1.5, 5, 180, 0.5, 3, 8,
+                   sf::Color(255, 255, 255, 70), sf::Color(255, 255, 255, 0)),
+    spawnParticles(0.6, 200, 180, 3, 6, 2,
+                   sf::Color(255, 255, 255, 200), sf::Color(120, 180, 255, 0)),
+    killParticles(1.2, 350, 180, 2, 12, 4,
+                  sf::Color(255, 200, 60, 255), sf::Color(60, 60, 60, 0)),
+    impactParticles(0.25, 150, 180, 4, 4, 1,
+                    sf::Color(255, 255, 180, 255), sf::Color(255, 120, 0, 0)),
+    spawnBurst(40),
+    killBurst(120),
+    impactBurst(8) { }
 
 Style::Style() :
     base(),
@@ -21,6 +21,7 @@
 #pragma once
 #include "ui/control.hpp"
 #include "ui/widgets.hpp"
+#include "client/engine/particles.hpp"
 
 struct Style {
   /**
@@ -56,6 +57,9 @@ struct Style {
     // Debug.
     float debugMargin, debugHeight;
     sf::Color debugBackground;
+    float debugGraphHeight; // frame time graph, under the left debug panel
+    TimeDiff debugGraphScale; // frame time at the top of the graph
+    sf::Color debugGraphColor, debugGraphSlowColor, debugGraphTarget;
 
     Base();
   } base;
@@ -209,8 +213,6 @@ struct Style {
         rollSpeed, // how quickly it rolls 2 * rollAmount
         flipSpeed; // how quickly it flips orientation
 
-    sf::FloatRect afterburnArea;
-
     sf::FloatRect barArea;
     sf::Color
         throttleStall,
@@ -221,6 +223,17 @@ struct Style {
 
     float planeGraphicsScale;
 
+    sf::Color obstacleFill, obstacleOutline;
+    float obstacleOutlineThickness;
+
+    float cullMargin; // room around planes for name tags and bars
+
+    size_t particleCapacity;
+    float afterburnRate, trailRate; // particles per second, per plane
+    sky::ParticleStyle afterburnParticles, trailParticles,
+        spawnParticles, killParticles, impactParticles;
+    size_t spawnBurst, killBurst, impactBurst; // particles per event
+
     SkyRender();
   } skyRender;
 
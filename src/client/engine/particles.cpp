@@ -0,0 +1,163 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "particles.hpp"
+#include "util/methods.hpp"
+
+namespace sky {
+
+/**
+ * ParticleStyle.
+ */
+
+ParticleStyle::ParticleStyle(const float lifetime, const float speed,
+                             const float spread, const float drag,
+                             const float startSize, const float endSize,
+                             const sf::Color &startColor,
+                             const sf::Color &endColor) :
+    lifetime(lifetime),
+    speed(speed),
+    spread(spread),
+    drag(drag),
+    startSize(startSize),
+    endSize(endSize),
+    startColor(startColor),
+    endColor(endColor) { }
+
+/**
+ * ParticleSystem.
+ */
+
+float ParticleSystem::random(const float min, const float max) {
+  return std::uniform_real_distribution<float>(min, max)(generator);
+}
+
+void ParticleSystem::remove(const size_t i) {
+  // Swap the last particle into the hole.
+  const size_t last = --count;
+  posX[i] = posX[last];
+  posY[i] = posY[last];
+  velX[i] = velX[last];
+  velY[i] = velY[last];
+  drag[i] = drag[last];
+  age[i] = age[last];
+  lifetime[i] = lifetime[last];
+  startSize[i] = startSize[last];
+  endSize[i] = endSize[last];
+  startColor[i] = startColor[last];
+  endColor[i] = endColor[last];
+}
+
+ParticleSystem::ParticleSystem(const size_t capacity) :
+    capacity(capacity),
+    count(0),
+    posX(capacity), posY(capacity), velX(capacity), velY(capacity),
+    drag(capacity), age(capacity), lifetime(capacity),
+    startSize(capacity), endSize(capacity),
+    startColor(capacity), endColor(capacity),
+    vertices(capacity * 6),
+    drawn(0),
+    generator(1) { }
+
+void ParticleSystem::emit(const ParticleStyle &style, const size_t number,
+                          const sf::Vector2f &pos, const float direction,
+                          const sf::Vector2f &baseVel) {
+  const size_t end = std::min(capacity, count + number);
+  for (size_t i = count; i < end; ++i) {
+    const sf::Vector2f vel = baseVel
+        + random(0.5f, 1.0f) * style.speed * VecMath::fromAngle(
+            direction + random(-style.spread, style.spread));
+    posX[i] = pos.x;
+    posY[i] = pos.y;
+    velX[i] = vel.x;
+    velY[i] = vel.y;
+    drag[i] = style.drag;
+    age[i] = 0;
+    lifetime[i] = style.lifetime * random(0.75f, 1.0f);
+    startSize[i] = style.startSize;
+    endSize[i] = style.endSize;
+    startColor[i] = style.startColor;
+    endColor[i] = style.endColor;
+  }
+  count = end;
+}
+
+void ParticleSystem::tick(const TimeDiff delta) {
+  for (size_t i = 0; i < count; ++i) {
+    age[i] += delta;
+    const float damping = std::max(0.0f, 1 - drag[i] * delta);
+    velX[i] *= damping;
+    velY[i] *= damping;
+    posX[i] += velX[i] * delta;
+    posY[i] += velY[i] * delta;
+  }
+
+  // Expire in a second pass, so the first stays a straight loop.
+  for (size_t i = 0; i < count;) {
+    if (age[i] >= lifetime[i]) remove(i);
+    else ++i;
+  }
+}
+
+void ParticleSystem::render(ui::Frame &f, const sf::FloatRect &view) {
+  const auto mix = [](const sf::Uint8 from, const sf::Uint8 to,
+                      const float t) {
+    return sf::Uint8(float(from) + (float(to) - float(from)) * t);
+  };
+
+  size_t v = 0;
+  drawn = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const float t = age[i] / lifetime[i];
+    const float half = 0.5f * (startSize[i] + (endSize[i] - startSize[i]) * t);
+    const float x = posX[i], y = posY[i];
+    if (x + half < view.left or x - half > view.left + view.width
+        or y + half < view.top or y - half > view.top + view.height)
+      continue;
+
+    const sf::Color &from = startColor[i], &to = endColor[i];
+    const sf::Color color(mix(from.r, to.r, t), mix(from.g, to.g, t),
+                          mix(from.b, to.b, t), mix(from.a, to.a, t));
+    const sf::Vertex topLeft({x - half, y - half}, color),
+        topRight({x + half, y - half}, color),
+        bottomRight({x + half, y + half}, color),
+        bottomLeft({x - half, y + half}, color);
+    vertices[v++] = topLeft;
+    vertices[v++] = topRight;
+    vertices[v++] = bottomRight;
+    vertices[v++] = topLeft;
+    vertices[v++] = bottomRight;
+    vertices[v++] = bottomLeft;
+    drawn++;
+  }
+
+  f.drawVertices(vertices.data(), v, sf::PrimitiveType::Triangles);
+}
+
+void ParticleSystem::clear() {
+  count = 0;
+}
+
+size_t ParticleSystem::size() const {
+  return count;
+}
+
+size_t ParticleSystem::getDrawn() const {
+  return drawn;
+}
+
+}
@@ -0,0 +1,91 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Client-side particle effects.
+ */
+#pragma once
+#include <random>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "ui/frame.hpp"
+#include "util/types.hpp"
+
+namespace sky {
+
+/**
+ * How the particles of one effect are emitted, move and look.
+ */
+struct ParticleStyle {
+  ParticleStyle() = default;
+  ParticleStyle(const float lifetime, const float speed, const float spread,
+                const float drag, const float startSize, const float endSize,
+                const sf::Color &startColor, const sf::Color &endColor);
+
+  float lifetime; // seconds
+  float speed, spread; // px/s, and degrees either side of the direction
+  float drag; // fraction of velocity lost per second
+  float startSize, endSize;
+  sf::Color startColor, endColor;
+
+};
+
+/**
+ * Particles that are only ever seen, never simulated by the engine or sent
+ * over the network.
+ *
+ * Particles are kept in a fixed-capacity pool of flat arrays, allocated up
+ * front: emitting and expiring particles never allocates, and emission past
+ * the capacity is dropped. Each tick advances every particle in one pass,
+ * and each render builds the visible ones into one vertex array, drawn in a
+ * single call.
+ */
+class ParticleSystem {
+ private:
+  const size_t capacity;
+  size_t count;
+
+  std::vector<float> posX, posY, velX, velY, drag,
+      age, lifetime, startSize, endSize;
+  std::vector<sf::Color> startColor, endColor;
+
+  std::vector<sf::Vertex> vertices; // rebuilt each render
+  size_t drawn; // in the last render
+
+  std::minstd_rand generator; // seeded constantly, for reproducible effects
+  float random(const float min, const float max);
+
+  void remove(const size_t i);
+
+ public:
+  ParticleSystem(const size_t capacity);
+
+  // Emit `number` particles at `pos`, moving in `direction` (degrees) with
+  // the style's spread, on top of a base velocity.
+  void emit(const ParticleStyle &style, const size_t number,
+            const sf::Vector2f &pos, const float direction,
+            const sf::Vector2f &baseVel = {});
+  void tick(const TimeDiff delta);
+  void render(ui::Frame &f, const sf::FloatRect &view);
+  void clear();
+
+  size_t size() const;
+  size_t getDrawn() const;
+
+};
+
+}
@@ -17,6 +17,7 @@
  */
 #include "engine/sky/participation.hpp"
 #include "client/elements/style.hpp"
+#include "util/profiling.hpp"
 #include "skyrender.hpp"
 
 namespace sky {
@@ -30,7 +31,12 @@ PlaneGraphics::PlaneGraphics(const Player &player, const Participation &plane) :
     player(player),
     orientation(false),
     flipState(0),
-    rollState(0) { }
+    rollState(0),
+    afterburnOwed(0),
+    trailOwed(0) {
+  if (auto &spawned = participation.plane)
+    previous = latest = spawned->getState().physical;
+}
 
 void PlaneGraphics::tick(const float delta) {
   if (auto &plane = participation.plane) {
@@ -49,6 +55,28 @@ void PlaneGraphics::tick(const float delta) {
   }
 }
 
+void PlaneGraphics::captureState(const size_t steps, const TimeDiff step) {
+  if (auto &plane = participation.plane) {
+    const PhysicalState &current = plane->getState().physical;
+    if (steps == 1) {
+      previous = latest;
+    } else {
+      // We didn't see the state between the last two steps; it's close to
+      // a step back along the velocity.
+      previous = current;
+      previous.pos -= step * current.vel;
+      previous.rot -= step * current.rotvel;
+    }
+    latest = current;
+  }
+}
+
+PhysicalState PlaneGraphics::interpolated(const float alpha) const {
+  // Towards the live state, so corrections from the server show at once.
+  return PhysicalState::interpolate(
+      previous, participation.plane->getState().physical, alpha);
+}
+
 Angle PlaneGraphics::roll() const {
   Angle flipComponent;
   if (orientation) flipComponent = 90 - flipState * 180;
@@ -57,6 +85,7 @@ Angle PlaneGraphics::roll() const {
 }
 
 void PlaneGraphics::onSpawn() {
+  previous = latest = participation.plane->getState().physical;
   orientation =
       Angle(participation.plane->getState().physical.rot + 90) > 180;
   flipState = 0;
@@ -67,6 +96,127 @@ void PlaneGraphics::onKill() {
 
 }
 
+/**
+ * CullStats.
+ */
+
+void CullStats::printDebug(Printer &p) const {
+  p.printLn("planes drawn/culled: " + std::to_string(planesDrawn) + "/"
+                + std::to_string(planesCulled));
+  p.printLn("projectiles drawn/culled: " + std::to_string(projectilesDrawn)
+                + "/" + std::to_string(projectilesCulled));
+  p.printLn("map cells drawn/culled: " + std::to_string(mapCellsDrawn) + "/"
+                + std::to_string(mapCellsCulled));
+  p.printLn("particles drawn/culled: " + std::to_string(particlesDrawn) + "/"
+                + std::to_string(particlesCulled));
+}
+
+/**
+ * MapLayer.
+ */
+
+void MapLayer::appendTriangle(Cell &cell, const sf::Vector2f &a,
+                              const sf::Vector2f &b, const sf::Vector2f &c,
+                              const sf::Color &color) {
+  for (const auto &point : {a, b, c}) {
+    cell.vertices.append(sf::Vertex(point, color));
+
+    if (cell.empty) {
+      cell.bounds = sf::FloatRect(point, {0, 0});
+      cell.empty = false;
+      continue;
+    }
+    const float right = std::max(cell.bounds.left + cell.bounds.width, point.x),
+        bottom = std::max(cell.bounds.top + cell.bounds.height, point.y);
+    cell.bounds.left = std::min(cell.bounds.left, point.x);
+    cell.bounds.top = std::min(cell.bounds.top, point.y);
+    cell.bounds.width = right - cell.bounds.left;
+    cell.bounds.height = bottom - cell.bounds.top;
+  }
+}
+
+void MapLayer::appendEdge(Cell &cell, const sf::Vector2f &a,
+                          const sf::Vector2f &b, const float thickness,
+                          const sf::Color &color) {
+  const float length = VecMath::length(b - a);
+  if (length == 0) return;
+  // Extended by half the thickness at both ends, so corners are covered.
+  const sf::Vector2f along = (0.5f * thickness / length) * (b - a),
+      across(-along.y, along.x);
+  const sf::Vector2f start = a - along, end = b + along;
+  appendTriangle(cell, start + across, end + across, end - across, color);
+  appendTriangle(cell, start + across, end - across, start - across, color);
+}
+
+MapLayer::MapLayer(const Map &map) {
+  const auto &render = style.skyRender;
+  const auto &dims = map.getDimensions();
+  const size_t columns = size_t(std::max(1.0f, std::ceil(dims.x / cellSize))),
+      rows = size_t(std::max(1.0f, std::ceil(dims.y / cellSize)));
+  cells.resize(columns * rows);
+
+  for (const auto &obstacle : map.getObstacles()) {
+    const auto &local = obstacle.localVertices;
+    if (local.empty()) continue;
+
+    // Each obstacle lives in the cell holding its first vertex; the cell's
+    // bounds grow to cover it.
+    const sf::Vector2f anchor = obstacle.pos + local[0];
+    const size_t column = size_t(clamp<float>(0, columns - 1,
+                                              anchor.x / cellSize)),
+        row = size_t(clamp<float>(0, rows - 1, anchor.y / cellSize));
+    Cell &cell = cells[row * columns + column];
+    cell.vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+
+    if (render.obstacleFill.a > 0) {
+      const auto &tris = obstacle.triangles;
+      for (size_t i = 0; i + 2 < tris.size(); i += 3) {
+        appendTriangle(cell, obstacle.pos + local[tris[i]],
+                       obstacle.pos + local[tris[i + 1]],
+                       obstacle.pos + local[tris[i + 2]],
+                       render.obstacleFill);
+      }
+    }
+
+    for (size_t i = 0; i < local.size(); ++i) {
+      appendEdge(cell, obstacle.pos + local[i],
+                 obstacle.pos + local[(i + 1) % local.size()],
+                 render.obstacleOutlineThickness, render.obstacleOutline);
+    }
+  }
+
+  const bool useBuffers = sf::VertexBuffer::isAvailable();
+  for (auto &cell : cells) {
+    const size_t count = cell.vertices.getVertexCount();
+    if (count == 0) continue;
+
+    if (useBuffers) {
+      auto buffer = std::make_shared<sf::VertexBuffer>(
+          sf::PrimitiveType::Triangles, sf::VertexBuffer::Static);
+      if (buffer->create(count) and buffer->update(&cell.vertices[0])) {
+        cell.geometry = std::move(buffer);
+        cell.vertices.clear();
+        continue;
+      }
+    }
+    cell.geometry = std::make_shared<sf::VertexArray>(cell.vertices);
+    cell.vertices.clear();
+  }
+}
+
+void MapLayer::render(ui::Frame &f, const sf::FloatRect &view,
+                      CullStats &stats) const {
+  for (const auto &cell : cells) {
+    if (!cell.geometry) continue;
+    if (!cell.bounds.intersects(view)) {
+      stats.mapCellsCulled++;
+      continue;
+    }
+    stats.mapCellsDrawn++;
+    f.drawStatic(cell.geometry);
+  }
+}
+
 /**
  * RenderSystem.
  */
@@ -104,26 +254,67 @@ std::pair<float, const sf::Color &> mkBar(float x, const sf::Color &c) {
   return std::pair<float, const sf::Color &>(x, c);
 }
 
+bool SkyRender::planeVisible(const PlaneGraphics &graphics,
+                             const sf::FloatRect &view) const {
+  const auto &plane = graphics.participation.plane;
+  if (!plane) return false;
+  // Graphics span the plane's scaled length; name tags and bars the margin.
+  const float reach = style.skyRender.planeGraphicsScale
+      * plane->getTuning().hitbox.x + style.skyRender.cullMargin;
+  const auto &pos = plane->getState().physical.pos;
+  return view.intersects(
+      sf::FloatRect(pos - sf::Vector2f(reach, reach), {2 * reach, 2 * reach}));
+}
+
+void SkyRender::emitPlaneParticles(PlaneGraphics &graphics,
+                                   const TimeDiff delta) {
+  const auto &plane = graphics.participation.plane;
+  if (!plane) return;
+  const auto &state = plane->getState();
+  const auto &physical = state.physical;
+  const sf::Vector2f tail = physical.pos - 0.5f * plane->getTuning().hitbox.x
+      * VecMath::fromAngle(physical.rot);
+
+  // Owed particles accumulate, so low rates still emit at the right pace.
+  graphics.afterburnOwed +=
+      style.skyRender.afterburnRate * state.afterburner * delta;
+  graphics.trailOwed += style.skyRender.trailRate * delta;
+
+  const size_t afterburn = size_t(graphics.afterburnOwed),
+      trail = size_t(graphics.trailOwed);
+  graphics.afterburnOwed -= afterburn;
+  graphics.trailOwed -= trail;
+
+  particles.emit(style.skyRender.afterburnParticles, afterburn,
+                 tail, physical.rot + 180, physical.vel);
+  particles.emit(style.skyRender.trailParticles, trail, tail, 0);
+}
+
+float SkyRender::renderAlpha() const {
+  // The physics remainder, plus the time the app has run past its last tick.
+  const auto &physics = sky.getPhysics();
+  return clamp<float>(0, 1, physics.getAlpha() + shared.references.sinceTick()
+      / physics.getTimestep().step);
+}
+
 void SkyRender::renderPlaneGraphics(ui::Frame &f,
-                                    const PlaneGraphics &graphics) {
+                                    const PlaneGraphics &graphics,
+                                    const float alpha) {
   if (auto &plane = graphics.participation.plane) {
     auto &state = plane->getState();
     auto &tuning = plane->getTuning();
+    const PhysicalState physical = graphics.interpolated(alpha);
 
     const float scaleFactor = style.skyRender.planeGraphicsScale
         * tuning.hitbox.x / 200;
 
     f.withTransform(
         sf::Transform()
-            .translate(state.physical.pos)
-            .rotate(state.physical.rot), [&]() {
+            .translate(physical.pos)
+            .rotate(physical.rot), [&]() {
 
       f.withTransform(sf::Transform().scale(scaleFactor, scaleFactor), [&]() {
         // Plane graphics, scaled down so the plane's length is 200 px from this perspective.
-        f.withAlpha(state.afterburner, [&]() {
-          f.drawRect(style.skyRender.afterburnArea,
-                     sf::Color::Red);
-        });
         planeSheet.drawIndexAtRoll(
             f, sf::Vector2f(200, 200), graphics.roll());
       });
@@ -135,7 +326,7 @@ void SkyRender::renderPlaneGraphics(ui::Frame &f,
       }
     });
 
-    f.withTransform(sf::Transform().translate(state.physical.pos), [&]() {
+    f.withTransform(sf::Transform().translate(physical.pos), [&]() {
       const float airspeedStall = tuning.flight.threshold /
           tuning.flight.airspeedFactor;
       f.drawText({0, -style.skyRender.barArea.top - style.base.normalFontSize},
@@ -162,7 +353,7 @@ void SkyRender::renderPlaneGraphics(ui::Frame &f,
   }
 }
 
-void SkyRender::renderMap(ui::Frame &f) {
+void SkyRender::renderMap(ui::Frame &f, const sf::FloatRect &view) {
   const sky::Map &map = sky.getMap();
   const auto &dims = map.getDimensions();
 
@@ -171,10 +362,28 @@ void SkyRender::renderMap(ui::Frame &f) {
                {(dims.x / 2) - 800, 0},
                {0, 0, 1600, 900});
 
-  for (const auto &obstacle : map.getObstacles()) {
-    f.withTransform(sf::Transform().translate(obstacle.pos), [&]() {
-      f.drawPolyOutline(obstacle.localVertices, sf::Color::White);
-    });
+  if (!mapLayer) mapLayer = std::make_unique<MapLayer>(map);
+  mapLayer->render(f, view, cullStats);
+}
+
+void SkyRender::renderProjectiles(ui::Frame &f, const sf::FloatRect &view) {
+  static constexpr float radius = 3;
+  // Blended between steps like the planes, so shots leave the guns that
+  // fired them; they fly straight, so the previous position is exact.
+  const TimeDiff behind =
+      (1 - renderAlpha()) * sky.getPhysics().getTimestep().step;
+  const sf::FloatRect bounds(view.left - radius, view.top - radius,
+                             view.width + 2 * radius,
+                             view.height + 2 * radius);
+  const auto &projectiles = sky.getProjectiles();
+  for (size_t i = 0; i < projectiles.size(); ++i) {
+    const auto pos = projectiles.getPos(i) - behind * projectiles.getVel(i);
+    if (!bounds.contains(pos)) {
+      cullStats.projectilesCulled++;
+      continue;
+    }
+    cullStats.projectilesDrawn++;
+    f.drawCircle(pos, radius, sf::Color::White);
   }
 }
 
@@ -185,10 +394,12 @@ SkyRender::SkyRender(ClientShared &shared,
     ClientComponent(shared),
     Subsystem(arena),
     sky(sky),
+    physicsSteps(sky.getPhysics().getStepStats().totalSteps),
+    particles(style.skyRender.particleCapacity),
     resources(resources),
     sheet(ui::TextureID::PlayerSheet),
     planeSheet(resources.getTextureData(sheet).spritesheetForm.get(),
-               resources.getTexture(sheet)),
+               resources.getTextureHandle(sheet)),
     enableDebug(shared.references.settings.enableDebug) {
   arena.forPlayers([&](Player &player) { registerPlayer(player); });
 }
@@ -208,38 +419,90 @@ void SkyRender::unregisterPlayer(Player &player) {
 }
 
 void SkyRender::onTick(const float delta) {
-  for (auto &pair : graphics) pair.second.tick(delta);
+  const auto &physics = sky.getPhysics();
+  const size_t totalSteps = physics.getStepStats().totalSteps,
+      steps = totalSteps - physicsSteps;
+  physicsSteps = totalSteps;
+
+  for (auto &pair : graphics) {
+    if (steps > 0)
+      pair.second.captureState(steps, physics.getTimestep().step);
+    pair.second.tick(delta);
+    emitPlaneParticles(pair.second, delta);
+  }
+
+  for (const auto &hit : sky.getProjectileHits()) {
+    particles.emit(style.skyRender.impactParticles,
+                   style.skyRender.impactBurst, hit.pos, 0);
+  }
+  particles.tick(delta);
 }
 
 
 void SkyRender::onSpawn(Player &player) {
-  getPlayerData(player).onSpawn();
+  auto &graphics = getPlayerData(player);
+  graphics.onSpawn();
+  particles.emit(style.skyRender.spawnParticles, style.skyRender.spawnBurst,
+                 graphics.latest.pos, 0);
 }
 
 void SkyRender::onKill(Player &player) {
-  getPlayerData(player).onKill();
+  auto &graphics = getPlayerData(player);
+  graphics.onKill();
+  // The plane may be gone; where it was last seen is close enough.
+  particles.emit(style.skyRender.killParticles, style.skyRender.killBurst,
+                 graphics.latest.pos, 0, graphics.latest.vel);
 }
 
 void SkyRender::onChangeSettings(const ui::SettingsDelta &settings) {
   if (settings.enableDebug) enableDebug = settings.enableDebug.get();
 }
 
+sf::Vector2f SkyRender::focusPos(const Player &player) const {
+  const auto iter = graphics.find(player.pid);
+  if (iter == graphics.end() or !iter->second.participation.plane) return {};
+  return iter->second.interpolated(renderAlpha()).pos;
+}
+
 void SkyRender::render(ui::Frame &f, const sf::Vector2f &pos) {
+  ProfileScope scope(ProfileStage::SkyRender);
   const auto &map = sky.getMap();
   const auto &dims = map.getDimensions();
   const auto &viewScale = sky.settings.getViewscale();
 
+  const sf::Vector2f viewSize(1600 / viewScale, 900 / viewScale);
+  const sf::FloatRect view(findView(viewSize.x, dims.x, pos.x),
+                           findView(viewSize.y, dims.y, pos.y),
+                           viewSize.x, viewSize.y);
+  cullStats = CullStats();
+  const float alpha = renderAlpha();
+
   f.withTransform(
       sf::Transform()
           .scale(viewScale, viewScale)
-          .translate(
-              {-findView(1600 / viewScale, dims.x, pos.x),
-               -findView(900 / viewScale, dims.y, pos.y)}),
+          .translate({-view.left, -view.top}),
       [&]() {
-        renderMap(f);
-        for (auto &pair: graphics) renderPlaneGraphics(f, pair.second);
+        renderMap(f, view);
+        particles.render(f, view);
+        cullStats.particlesDrawn = particles.getDrawn();
+        cullStats.particlesCulled = particles.size() - particles.getDrawn();
+        for (auto &pair: graphics) {
+          if (!pair.second.participation.plane) continue;
+          if (planeVisible(pair.second, view)) {
+            cullStats.planesDrawn++;
+            renderPlaneGraphics(f, pair.second, alpha);
+          } else {
+            cullStats.planesCulled++;
+          }
+        }
+        renderProjectiles(f, view);
       }
   );
 }
 
+void SkyRender::printDebug(Printer &p) const {
+  p.printTitle("SkyRender");
+  cullStats.printDebug(p);
+}
+
 }
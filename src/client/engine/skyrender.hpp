@@ -20,12 +20,14 @@
  */
 #pragma once
 #include <list>
+#include <memory>
 #include <SFML/Graphics.hpp>
 #include "client/elements/elements.hpp"
 #include "ui/resources.hpp"
 #include "ui/control.hpp"
 #include "ui/sheet.hpp"
 #include "engine/sky/sky.hpp"
+#include "particles.hpp"
 
 namespace sky {
 
@@ -41,6 +43,13 @@ struct PlaneGraphics {
   float flipState, rollState; // these two values contribute to the roll
   Angle roll() const;
 
+  // States before and after the latest physics step, rendered in between.
+  PhysicalState previous, latest;
+  void captureState(const size_t steps, const TimeDiff step); // after steps
+  PhysicalState interpolated(const float alpha) const;
+
+  float afterburnOwed, trailOwed; // fractional particles, carried over ticks
+
   void tick(const float delta);
 
   void onSpawn();
@@ -48,6 +57,51 @@ struct PlaneGraphics {
 
 };
 
+/**
+ * What SkyRender drew and what it culled in the last frame.
+ */
+struct CullStats {
+  size_t planesDrawn = 0, planesCulled = 0,
+      projectilesDrawn = 0, projectilesCulled = 0,
+      mapCellsDrawn = 0, mapCellsCulled = 0,
+      particlesDrawn = 0, particlesCulled = 0;
+
+  void printDebug(Printer &p) const;
+
+};
+
+/**
+ * The static geometry of a Map, cut into a uniform grid of cells. Each cell
+ * is built once into a vertex buffer (or a vertex array, where buffers aren't
+ * supported), and drawn in a single call when it overlaps the view.
+ */
+class MapLayer {
+ private:
+  struct Cell {
+    sf::FloatRect bounds; // of everything in the cell
+    bool empty = true;
+    sf::VertexArray vertices; // while building
+    std::shared_ptr<const sf::Drawable> geometry;
+  };
+
+  static constexpr float cellSize = 1024;
+  std::vector<Cell> cells;
+
+  static void appendTriangle(Cell &cell, const sf::Vector2f &a,
+                             const sf::Vector2f &b, const sf::Vector2f &c,
+                             const sf::Color &color);
+  static void appendEdge(Cell &cell, const sf::Vector2f &a,
+                         const sf::Vector2f &b, const float thickness,
+                         const sf::Color &color);
+
+ public:
+  MapLayer(const Map &map);
+
+  void render(ui::Frame &f, const sf::FloatRect &view,
+              CullStats &stats) const;
+
+};
+
 /**
  * Subsystem, attaching additional graphics-related state to Players and
  * exposing top-level methods for rendering the game.
@@ -62,6 +116,10 @@ class SkyRender
 
   // State.
   std::map<PID, PlaneGraphics> graphics;
+  std::unique_ptr<MapLayer> mapLayer; // built on first render
+  CullStats cullStats;
+  size_t physicsSteps; // as of the last tick
+  ParticleSystem particles;
 
   // Resources.
   const ui::AppResources &resources;
@@ -75,8 +133,14 @@ class SkyRender
   void renderBars(ui::Frame &f,
                   std::vector<std::pair<float, const sf::Color &>> bars,
                   sf::FloatRect area);
-  void renderPlaneGraphics(ui::Frame &f, const PlaneGraphics &graphics);
-  void renderMap(ui::Frame &f);
+  bool planeVisible(const PlaneGraphics &graphics,
+                    const sf::FloatRect &view) const;
+  float renderAlpha() const;
+  void emitPlaneParticles(PlaneGraphics &graphics, const TimeDiff delta);
+  void renderPlaneGraphics(ui::Frame &f, const PlaneGraphics &graphics,
+                           const float alpha);
+  void renderMap(ui::Frame &f, const sf::FloatRect &view);
+  void renderProjectiles(ui::Frame &f, const sf::FloatRect &view);
 
  protected:
   // Subsystem impl.
@@ -97,7 +161,9 @@ class SkyRender
   void onChangeSettings(const ui::SettingsDelta &settings) override final;
 
   // User API.
+  sf::Vector2f focusPos(const Player &player) const; // where it's drawn
   void render(ui::Frame &f, const sf::Vector2f &pos);
+  void printDebug(Printer &p) const;
   bool enableDebug;
 };
 
@@ -18,9 +18,30 @@
 /**
  * Client top-level.
  */
+#include <cstdlib>
+#include <new>
 #include "ui/control.hpp"
+#include "util/profiling.hpp"
 #include "client.hpp"
 
+/**
+ * Count heap allocations for the profiler. The array forms forward to
+ * these by default.
+ */
+void *operator new(std::size_t size) {
+  countAllocation();
+  if (void *ptr = std::malloc(size ? size : 1)) return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
 int main() {
   // TODO: commandline arguments?
   // and He said,
@@ -111,6 +111,10 @@ void Multiplayer::printDebugRight(Printer &p) {
                   + printKbps(core.getHost().outgoingBandwidth()));
     p.breakLine();
     core.conn->skyDeltaCache.printDebug(p);
+    if (view) {
+      p.breakLine();
+      view->printDebug(p);
+    }
   } else {
     p.printLn("not connected...");
   }
@@ -200,4 +200,7 @@ class MultiplayerView: public ClientComponent, public ui::Control {
   virtual void handleSkyAction(const sky::Action action, const bool state) { }
   virtual void handleClientAction(const ui::ClientAction action, const bool state) { }
 
+  // Debug printing, for views that have something to say.
+  virtual void printDebug(Printer &p) { }
+
 };
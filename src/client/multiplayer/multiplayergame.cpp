@@ -97,10 +97,7 @@ void MultiplayerGame::tick(float delta) {
 }
 
 void MultiplayerGame::render(ui::Frame &f) {
-  skyRender.render(
-      f, participation.plane ?
-         participation.plane->getState().physical.pos :
-         sf::Vector2f(0, 0));
+  skyRender.render(f, skyRender.focusPos(conn.player));
 
   ui::Control::render(f);
 
@@ -146,6 +143,10 @@ void MultiplayerGame::handleClientAction(const ui::ClientAction action,
   }
 }
 
+void MultiplayerGame::printDebug(Printer &p) {
+  skyRender.printDebug(p);
+}
+
 /**
  * MultiplayerSplash.
  */
@@ -50,6 +50,7 @@ class MultiplayerGame: public MultiplayerView {
   // MultiplayerView impl.
   void handleSkyAction(const sky::Action action, const bool state) override;
   void handleClientAction(const ui::ClientAction action, const bool state) override final;
+  void printDebug(Printer &p) override final;
 
 };
 
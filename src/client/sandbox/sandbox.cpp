@@ -65,6 +65,12 @@ optional<SandboxCommand> SandboxCommand::parseCommand(
     return SandboxCommand(Type::DumpTuning);
   }
 
+  if (command[0] == "profile" and command.size() == 2) {
+    SandboxCommand parsed{Type::DumpProfile};
+    parsed.profilePath.emplace(command[1]);
+    return parsed;
+  }
+
   return {};
 }
 
@@ -135,6 +141,16 @@ void Sandbox::runCommand(const SandboxCommand &command) {
       appLog("\n" + spawnTuning.toString());
       return;
     }
+    case SandboxCommand::Type::DumpProfile: {
+      const auto &path = command.profilePath.get();
+      if (references.profiler.writeCSV(path)) {
+        consolePrinter.output("Wrote " + std::to_string(
+            references.profiler.history.size()) + " frames to " + inQuotes(path));
+      } else {
+        consolePrinter.output("Could not write profile to " + inQuotes(path));
+      }
+      return;
+    }
   }
 
   throw enum_error();
@@ -210,12 +226,8 @@ void Sandbox::tick(const TimeDiff delta) {
 }
 
 void Sandbox::render(ui::Frame &f) {
-  if (auto sky = skyHandle.getSky()) {
-    const auto &plane = sky->getParticipation(*player).plane;
-    skyRender->render(
-        f, plane ?
-           plane->getState().physical.pos :
-           sf::Vector2f(0, 0));
+  if (skyHandle.getSky()) {
+    skyRender->render(f, skyRender->focusPos(*player));
   } else {
     if (const auto environment = skyHandle.getEnvironment()) {
       if (environment->loadingErrored()) {
@@ -290,6 +302,10 @@ void Sandbox::printDebugLeft(Printer &p) {
 
 void Sandbox::printDebugRight(Printer &p) {
   debugView.printSkyReport(p);
+  if (skyRender) {
+    p.breakLine();
+    skyRender->printDebug(p);
+  }
 }
 
 std::string Sandbox::getQuittingReason() const {
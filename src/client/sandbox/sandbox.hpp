@@ -37,7 +37,8 @@ struct SandboxCommand {
     Stop, // stop the game
     Tune, // modify or query some PlaneTuning value
     DefaultTuning, // reset tuning to default
-    DumpTuning // dump the tuning data to disk
+    DumpTuning, // dump the tuning data to disk
+    DumpProfile // write the profiler's frame history to a CSV file
   };
 
  private:
@@ -50,6 +51,7 @@ struct SandboxCommand {
   optional<std::string> mapName; // on Start command
   optional<std::string> tuningParam;
   optional<float> tuningValue;
+  optional<std::string> profilePath; // on DumpProfile command
 
   static optional<SandboxCommand> parseCommand(const std::string &input);
 
@@ -213,6 +213,10 @@ void SettingsPage::tick(float delta) {
   ui::Control::tick(delta);
 }
 
+bool SettingsPage::animating() const {
+  return currentTab.second->animating() or ui::Control::animating();
+}
+
 void SettingsPage::render(ui::Frame &f) {
   drawBackground(f);
   currentTab.second->render(f);
@@ -102,4 +102,5 @@ class SettingsPage : public Page {
   void reset() override final;
   void signalRead() override final;
   void signalClear() override final;
+  bool animating() const override final;
 };
@@ -18,6 +18,7 @@
 #include <boost/algorithm/string.hpp>
 #include "arena.hpp"
 #include "event.hpp"
+#include "util/profiling.hpp"
 
 namespace sky {
 
@@ -457,6 +458,7 @@ void Arena::tick(const TimeDiff delta) {
     for (auto s : subsystems) s.second->onDebugRefresh();
     debugTimer.reset();
   }
+  ProfileScope scope(ProfileStage::Subsystems);
   for (auto s : subsystems) s.second->onTick(delta);
 }
 
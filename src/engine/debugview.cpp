@@ -67,6 +67,8 @@ void DebugView::printSkyReport(Printer &p) const {
   p.printLn("bool(getSky()): " + printBool(bool(skyHandle.getSky())));
   p.printLn("bool(getEnvironment()): "
             + printBool(bool(skyHandle.getEnvironment())));
+  p.printLn("EnvironmentCache::global().getStats(): "
+            + sky::EnvironmentCache::global().getStats().print());
 
   if (const auto sky = skyHandle.getSky()) {
     p.printLn("environment.url: " + skyHandle.getEnvironment()->url);
@@ -74,6 +76,10 @@ void DebugView::printSkyReport(Printer &p) const {
               + printFloat(sky->settings.getGravity()));
     p.printLn("sky.settings.getViewScale(): "
               + printFloat(sky->settings.getViewscale()));
+    p.printLn("sky.getPhysics().getStepStats(): "
+              + sky->getPhysics().getStepStats().print());
+    p.printLn("sky.getPhysics().getPoolStats(): "
+              + sky->getPhysics().getPoolStats().print());
 
     p.breakLine();
     if (playerID) {
@@ -15,7 +15,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <fstream>
+#include <sstream>
 #include <util/methods.hpp>
 #include "util/printer.hpp"
 #include "util/methods.hpp"
@@ -44,6 +44,10 @@ std::string Environment::describeComponentDone(const Environment::Component c) {
   return "Loaded " + describeComponent(c) + " component!";
 }
 
+std::string Environment::describeComponentCached(const Component c) {
+  return "Using cached " + describeComponent(c) + " component.";
+}
+
 std::string Environment::describeComponentLoadingNull(const Component c) {
   return "Creating null " + describeComponent(c)
       + " component for environment...";
@@ -57,11 +61,33 @@ std::string Environment::describeComponentMalformed(const Component c) {
   return "Environment " + describeComponent(c) + " component data appears to be malformed!";
 }
 
-void Environment::loadMap(const fs::path &path) {
+template<typename T>
+void Environment::publish(std::shared_ptr<const T> &member,
+                          const std::shared_ptr<const T> &value) {
+  std::lock_guard<std::mutex> lock(mutex);
+  member = value;
+}
+
+void Environment::loadMap(const std::string &data) {
+  appLog(describeComponentLoading(Component::Map), LogOrigin::Engine);
+  std::istringstream stream(data);
+  if (auto map = Map::load(stream)) {
+    const auto loaded = std::make_shared<const Map>(std::move(map.get()));
+    cache.putMap(cacheKey.get(), loaded);
+    publish(this->map, loaded);
+  } else {
+    appLog(describeComponentMalformed(Component::Map), LogOrigin::Error);
+    loadError = true;
+  }
+  appLog(describeComponentDone(Component::Map), LogOrigin::Engine);
+}
+
+void Environment::loadCompiledMap(const char *data, const size_t size) {
   appLog(describeComponentLoading(Component::Map), LogOrigin::Engine);
-  std::ifstream mapFile(path.string());
-  if (auto map = Map::load(mapFile)) {
-    this->map.emplace(std::move(map.get()));
+  if (auto map = Map::loadCompiled(data, size)) {
+    const auto loaded = std::make_shared<const Map>(std::move(map.get()));
+    cache.putMap(cacheKey.get(), loaded);
+    publish(this->map, loaded);
   } else {
     appLog(describeComponentMalformed(Component::Map), LogOrigin::Error);
     loadError = true;
@@ -69,75 +95,164 @@ void Environment::loadMap(const fs::path &path) {
   appLog(describeComponentDone(Component::Map), LogOrigin::Engine);
 }
 
-void Environment::loadMechanics(const fs::path &path) {
+void Environment::loadMechanics(const std::string &data) {
   appLog(describeComponentLoading(Component::Mechanics), LogOrigin::Engine);
-  mechanics.emplace();
+  const auto loaded = std::make_shared<const Mechanics>();
+  cache.putMechanics(cacheKey.get(), loaded);
+  publish(mechanics, loaded);
   appLog(describeComponentDone(Component::Mechanics), LogOrigin::Engine);
 }
 
-void Environment::loadVisuals(const fs::path &path) {
+void Environment::loadVisuals(const std::string &data) {
   appLog(describeComponentLoading(Component::Visuals), LogOrigin::Engine);
-  visuals.emplace();
+  const auto loaded = std::make_shared<const Visuals>();
+  cache.putVisuals(cacheKey.get(), loaded);
+  publish(visuals, loaded);
   appLog(describeComponentDone(Component::Visuals), LogOrigin::Engine);
 }
 
 void Environment::loadNullMap() {
   appLog(describeComponentLoadingNull(Component::Map), LogOrigin::Engine);
-  map.emplace();
-  sf::sleep(sf::milliseconds(20));
+  publish(map, std::make_shared<const Map>());
   appLog(describeComponentDone(Component::Map), LogOrigin::Engine);
 }
 
 void Environment::loadNullMechanics() {
   appLog(describeComponentLoadingNull(Component::Mechanics), LogOrigin::Engine);
-  mechanics.emplace();
-  sf::sleep(sf::milliseconds(20));
+  publish(mechanics, std::make_shared<const Mechanics>());
   appLog(describeComponentDone(Component::Mechanics), LogOrigin::Engine);
 }
 
 void Environment::loadNullVisuals() {
   appLog(describeComponentLoadingNull(Component::Visuals), LogOrigin::Engine);
-  visuals.emplace();
-  sf::sleep(sf::milliseconds(20));
+  publish(visuals, std::make_shared<const Visuals>());
   appLog(describeComponentDone(Component::Visuals), LogOrigin::Engine);
 }
 
-Environment::Environment(const EnvironmentURL &url) :
+TaskHandle Environment::submitStage(const std::string &name,
+                                    std::function<void()> stage,
+                                    const std::vector<TaskHandle> &after) {
+  stagesTotal++;
+  auto task = pool.submit([this, name, stage]() {
+    sf::Clock clock;
+    if (!cancelled) stage();
+    const TimeDiff time = clock.getElapsedTime().asSeconds();
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stageTimes[name] = time;
+    }
+    stagesDone++;
+  }, after);
+  tasks.push_back(task);
+  return task;
+}
+
+void Environment::loadArchive() {
+  fileArchive.load();
+  if (fileArchive.isOpen()) {
+    cacheKey.emplace(url, fileArchive.getChecksum());
+  } else {
+    appLog("Could not open environment archive at path "
+               + archivePath.string(), LogOrigin::Error);
+    loadError = true;
+  }
+}
+
+void Environment::prepareMap() {
+  if (url == "NULL") {
+    loadNullMap();
+    return;
+  }
+  if (!cacheKey) return;
+
+  if (const auto cachedMap = cache.getMap(cacheKey.get())) {
+    appLog(describeComponentCached(Component::Map), LogOrigin::Engine);
+    publish(map, cachedMap);
+  } else if (fileArchive.hasFile("map.skymap")) {
+    // Compiled maps are stored uncompressed, and read straight from the
+    // archive without inflating a copy first.
+    size_t size;
+    if (const char *view = fileArchive.viewFile("map.skymap", size)) {
+      loadCompiledMap(view, size);
+    } else if (const auto mapData = fileArchive.readFile("map.skymap")) {
+      loadCompiledMap(mapData->data(), mapData->size());
+    } else {
+      appLog(describeComponentMalformed(Component::Map), LogOrigin::Error);
+      loadError = true;
+    }
+  } else if (const auto mapData = fileArchive.readFile("map.json")) {
+    loadMap(mapData.get());
+  } else {
+    appLog(describeComponentMissing(Component::Map), LogOrigin::Error);
+    loadError = true;
+  }
+}
+
+void Environment::prepareVisuals() {
+  if (url == "NULL") {
+    loadNullVisuals();
+    return;
+  }
+  if (!cacheKey) return;
+
+  if (const auto cachedVisuals = cache.getVisuals(cacheKey.get())) {
+    appLog(describeComponentCached(Component::Visuals), LogOrigin::Engine);
+    publish(visuals, cachedVisuals);
+  } else if (const auto visualData = fileArchive.readFile("graphics.json")) {
+    loadVisuals(visualData.get());
+  } else {
+    appLog(describeComponentMissing(Component::Visuals), LogOrigin::Error);
+    loadError = true;
+  }
+}
+
+void Environment::prepareMechanics() {
+  if (url == "NULL") {
+    loadNullMechanics();
+    return;
+  }
+  if (!cacheKey) return;
+
+  if (const auto cachedMechanics = cache.getMechanics(cacheKey.get())) {
+    appLog(describeComponentCached(Component::Mechanics), LogOrigin::Engine);
+    publish(mechanics, cachedMechanics);
+  } else if (const auto mechanicsData =
+      fileArchive.readFile("mechanics.json")) {
+    loadMechanics(mechanicsData.get());
+  } else {
+    appLog(describeComponentMissing(Component::Mechanics), LogOrigin::Error);
+    loadError = true;
+  }
+}
+
+Environment::Environment(const EnvironmentURL &url, EnvironmentCache &cache,
+                         TaskPool &pool) :
     archivePath(fs::system_complete(getEnvironmentPath(url + ".sky"))),
     fileArchive(archivePath),
-    workerRunning(false),
+    cache(cache),
+    cancelled(false),
     loadError(false),
-    loadProgress(0),
+    pool(pool),
+    visualsRequested(false),
+    mechanicsRequested(false),
+    stagesDone(0),
+    stagesTotal(0),
     url(url) {
   if (url == "NULL") {
     appLog("Creating null environment.", LogOrigin::Engine);
-    workerThread = std::thread([&]() { loadNullMap(); });
   } else {
     appLog("Creating environment " + inQuotes(url)
                + " with environment file " + archivePath.string(),
            LogOrigin::Engine);
-
-    workerRunning = true;
-    workerThread = std::thread([&]() {
-      fileArchive.load();
-      if (const auto dir = fileArchive.getResult()) {
-        if (const auto mapPath = dir->getTopFile("map.json")) {
-          loadMap(mapPath.get());
-        } else {
-          appLog(describeComponentMissing(Component::Map), LogOrigin::Error);
-          loadError = true;
-        }
-      } else {
-        appLog("Could not open environment archive at path "
-                   + archivePath.string(), LogOrigin::Error);
-        loadError = true;
-      }
-
-      workerRunning = false;
-    });
+    archiveTask = submitStage("archive", [this]() { loadArchive(); });
   }
+
+  submitStage("map", [this]() { prepareMap(); }, {archiveTask});
 }
 
+Environment::Environment(const EnvironmentURL &url) :
+    Environment(url, EnvironmentCache::global()) {}
+
 Environment::Environment() :
     Environment("NULL") {}
 
@@ -147,53 +262,23 @@ Environment::~Environment() {
 
 void Environment::loadMore(
     const bool needVisuals, const bool needMechanics) {
-  if (loadingIdle()) {
-    joinWorker();
-    assert(!loadError);
-    assert(imply(needVisuals, !visuals));
-    assert(imply(needMechanics, !mechanics));
-
-    appLog("Beginning secondary environment loading.", LogOrigin::Engine);
-
-    workerRunning = true;
-    workerThread = std::thread([&, needVisuals, needMechanics]() {
-      if (url == "NULL") {
-        if (needVisuals) loadNullVisuals();
-        if (needMechanics) loadNullMechanics();
-      } else {
-        const auto dir = *this->fileArchive.getResult();
-
-        if (needVisuals) {
-          if (const auto visualFile = dir.getTopFile("graphics.json")) {
-            loadVisuals(visualFile.get());
-          } else {
-            appLog(describeComponentMissing(Component::Visuals),
-                   LogOrigin::Error);
-            loadError = true;
-          }
-        }
-
-        if (needMechanics) {
-          if (const auto mechanicsFile = dir.getTopFile("mechanics.json")) {
-            loadMechanics(mechanicsFile.get());
-          } else {
-            appLog(describeComponentMissing(Component::Mechanics),
-                   LogOrigin::Error);
-            loadError = true;
-          }
-        }
-      }
-
-      workerRunning = false;
-    });
-  } else {
-    appLog("Tried to start secondary loading before primary loading finished.", LogOrigin::Error);
+  if (needVisuals and !visualsRequested) {
+    visualsRequested = true;
+    submitStage("visuals", [this]() { prepareVisuals(); }, {archiveTask});
   }
+
+  if (needMechanics and !mechanicsRequested) {
+    mechanicsRequested = true;
+    submitStage("mechanics", [this]() { prepareMechanics(); }, {archiveTask});
+  }
+}
+
+void Environment::cancel() {
+  cancelled = true;
 }
 
 void Environment::joinWorker() {
-  if (workerThread.joinable())
-    workerThread.join();
+  for (const auto &task : tasks) pool.wait(task);
 }
 
 bool Environment::loadingErrored() const {
@@ -201,23 +286,31 @@ bool Environment::loadingErrored() const {
 }
 
 bool Environment::loadingIdle() const {
-  return !workerRunning;
+  return stagesDone == stagesTotal;
 }
 
 float Environment::loadingProgress() const {
-  return loadProgress;
+  return stagesTotal == 0 ? 1 : float(stagesDone) / float(stagesTotal);
+}
+
+std::map<std::string, TimeDiff> Environment::getStageTimes() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stageTimes;
 }
 
 Map const *Environment::getMap() const {
-  return map.get_ptr();
+  std::lock_guard<std::mutex> lock(mutex);
+  return map.get();
 }
 
 Visuals const *Environment::getVisuals() const {
-  return visuals.get_ptr();
+  std::lock_guard<std::mutex> lock(mutex);
+  return visuals.get();
 }
 
 Mechanics const *Environment::getMechanics() const {
-  return mechanics.get_ptr();
+  std::lock_guard<std::mutex> lock(mutex);
+  return mechanics.get();
 }
 
 }
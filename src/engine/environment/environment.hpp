@@ -19,6 +19,7 @@
  * Set of static information that surrounds a Sky.
  */
 #pragma once
+#include <atomic>
 #include "util/types.hpp"
 #include "visuals.hpp"
 #include "mechanics.hpp"
@@ -26,6 +27,7 @@
 #include "util/threads.hpp"
 #include "util/archive.hpp"
 #include "engine/types.hpp"
+#include "environmentcache.hpp"
 
 namespace sky {
 
@@ -33,36 +35,66 @@ namespace sky {
  * Holder and asynchronous loader for pieces of static information extracted
  * from a .sky file, used to instantiate / add to the functionality /
  * display a Sky -- geometry data, scripts, and graphics resources.
+ *
+ * Loading is split into stages that run as tasks on the shared TaskPool:
+ * the archive first, then the map, visuals and mechanics independently.
+ * Components already loaded from the same file are taken from an
+ * EnvironmentCache instead of being parsed again.
  */
 class Environment {
  private:
   // Associated archive and filepath -- this makes no sense if the environment is NULL.
   fs::path archivePath;
   Archive fileArchive;
+  EnvironmentCache &cache;
+  optional<EnvironmentKey> cacheKey; // Set once fileArchive is loaded.
+
+  // State. Components are set by the loading stages, under `mutex`.
+  std::atomic<bool> cancelled;
+  std::atomic<bool> loadError;
+  std::shared_ptr<const Map> map;
+  std::shared_ptr<const Visuals> visuals;
+  std::shared_ptr<const Mechanics> mechanics;
+  template<typename T>
+  void publish(std::shared_ptr<const T> &member,
+               const std::shared_ptr<const T> &value);
 
-  // State.
-  bool workerRunning;
-  bool loadError;
-  float loadProgress;
-  optional<Map> map;
-  optional<Visuals> visuals;
-  optional<Mechanics> mechanics;
+  // Loading tasks and their progress.
+  TaskPool &pool;
+  TaskHandle archiveTask;
+  std::vector<TaskHandle> tasks;
+  bool visualsRequested, mechanicsRequested;
+  std::atomic<size_t> stagesDone;
+  size_t stagesTotal;
+  std::map<std::string, TimeDiff> stageTimes; // under `mutex`
+  mutable std::mutex mutex;
 
-  std::thread workerThread;
+  // Submit a loading stage, timed and counted towards progress.
+  TaskHandle submitStage(const std::string &name,
+                         std::function<void()> stage,
+                         const std::vector<TaskHandle> &after = {});
 
   // Canonical logging messages.
   enum class Component { Map, Mechanics, Visuals };
   static std::string describeComponent(const Component c);
   static std::string describeComponentLoading(const Component c);
   static std::string describeComponentDone(const Component c);
+  static std::string describeComponentCached(const Component c);
   static std::string describeComponentLoadingNull(const Component c);
   static std::string describeComponentMissing(const Component c);
   static std::string describeComponentMalformed(const Component c);
 
-  // Loading subroutines -- they expect fileArchive to be loaded.
-  void loadMap(const fs::path &path);
-  void loadMechanics(const fs::path &path);
-  void loadVisuals(const fs::path &path);
+  // Loading stages -- all but the first expect fileArchive to be loaded.
+  void loadArchive();
+  void prepareMap();
+  void prepareVisuals();
+  void prepareMechanics();
+
+  // Loading subroutines, reading archive members inflated into memory.
+  void loadMap(const std::string &data);
+  void loadCompiledMap(const char *data, const size_t size);
+  void loadMechanics(const std::string &data);
+  void loadVisuals(const std::string &data);
 
   // Null loading subroutines.
   void loadNullMap();
@@ -71,6 +103,8 @@ class Environment {
 
  public:
   Environment(const EnvironmentURL &url);
+  Environment(const EnvironmentURL &url, EnvironmentCache &cache,
+              TaskPool &pool = TaskPool::global());
   // The null environment, useful for testing and sandboxes.
   // The default ctor is equilivent to supplying a URL of "NULL".
   Environment();
@@ -78,14 +112,18 @@ class Environment {
 
   const EnvironmentURL url;
 
-  // Loading.
+  // Loading. Visuals and mechanics can be asked for at any time.
   void loadMore(const bool needVisuals, const bool needMechanics);
-  void joinWorker();
+  void joinWorker(); // Wait for every stage asked for so far.
+  // Ask the stages that haven't started to skip; what's loaded stays loaded.
+  void cancel();
 
   // Load status.
   bool loadingErrored() const;
   bool loadingIdle() const;
-  float loadingProgress() const;
+  float loadingProgress() const; // Fraction of the stages asked for.
+  // Wall time each finished stage took, in seconds.
+  std::map<std::string, TimeDiff> getStageTimes() const;
 
   // Accessing loaded resources. nullptr if they aren't loaded.
   Map const *getMap() const;
@@ -95,4 +133,3 @@ class Environment {
 };
 
 }
-
@@ -0,0 +1,154 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <tuple>
+#include "environmentcache.hpp"
+
+namespace sky {
+
+/**
+ * EnvironmentKey.
+ */
+
+EnvironmentKey::EnvironmentKey(const EnvironmentURL &url,
+                               const uint32_t checksum) :
+    url(url),
+    checksum(checksum) {}
+
+bool EnvironmentKey::operator==(const EnvironmentKey &x) const {
+  return url == x.url and checksum == x.checksum;
+}
+
+bool EnvironmentKey::operator<(const EnvironmentKey &x) const {
+  return std::tie(url, checksum) < std::tie(x.url, x.checksum);
+}
+
+/**
+ * EnvironmentCacheStats.
+ */
+
+EnvironmentCacheStats::EnvironmentCacheStats() :
+    hits(0),
+    misses(0),
+    evictions(0),
+    entries(0),
+    bytes(0) {}
+
+std::string EnvironmentCacheStats::print() const {
+  return std::to_string(hits) + " hits, "
+      + std::to_string(misses) + " misses, "
+      + std::to_string(evictions) + " evictions, "
+      + std::to_string(entries) + " entries, "
+      + std::to_string(bytes) + " bytes";
+}
+
+/**
+ * EnvironmentCache.
+ */
+
+EnvironmentCache::Entry::Entry(const EnvironmentKey &key) :
+    key(key),
+    bytes(0) {}
+
+EnvironmentCache::Entry *EnvironmentCache::touch(const EnvironmentKey &key) {
+  const auto found = index.find(key);
+  if (found == index.end()) return nullptr;
+  entries.splice(entries.begin(), entries, found->second);
+  return &entries.front();
+}
+
+EnvironmentCache::Entry &EnvironmentCache::touchOrCreate(
+    const EnvironmentKey &key) {
+  if (Entry *entry = touch(key)) return *entry;
+  entries.emplace_front(key);
+  index.emplace(key, entries.begin());
+  stats.entries++;
+  return entries.front();
+}
+
+void EnvironmentCache::evict() {
+  // The most recently used entry stays, even if it alone is over the limit.
+  while (stats.bytes > byteLimit and entries.size() > 1) {
+    const Entry &victim = entries.back();
+    stats.bytes -= victim.bytes;
+    stats.entries--;
+    stats.evictions++;
+    index.erase(victim.key);
+    entries.pop_back();
+  }
+}
+
+EnvironmentCache::EnvironmentCache(const size_t byteLimit) :
+    byteLimit(byteLimit) {}
+
+EnvironmentCache &EnvironmentCache::global() {
+  static EnvironmentCache cache;
+  return cache;
+}
+
+std::shared_ptr<const Map> EnvironmentCache::getMap(
+    const EnvironmentKey &key) {
+  return lookup(key, &Entry::map);
+}
+
+std::shared_ptr<const Visuals> EnvironmentCache::getVisuals(
+    const EnvironmentKey &key) {
+  return lookup(key, &Entry::visuals);
+}
+
+std::shared_ptr<const Mechanics> EnvironmentCache::getMechanics(
+    const EnvironmentKey &key) {
+  return lookup(key, &Entry::mechanics);
+}
+
+void EnvironmentCache::putMap(const EnvironmentKey &key,
+                              const std::shared_ptr<const Map> &map) {
+  insert(key, &Entry::map, map, map->residentBytes());
+}
+
+void EnvironmentCache::putVisuals(
+    const EnvironmentKey &key,
+    const std::shared_ptr<const Visuals> &visuals) {
+  insert(key, &Entry::visuals, visuals, sizeof(Visuals));
+}
+
+void EnvironmentCache::putMechanics(
+    const EnvironmentKey &key,
+    const std::shared_ptr<const Mechanics> &mechanics) {
+  insert(key, &Entry::mechanics, mechanics, sizeof(Mechanics));
+}
+
+void EnvironmentCache::setByteLimit(const size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex);
+  byteLimit = limit;
+  evict();
+}
+
+void EnvironmentCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  entries.clear();
+  index.clear();
+  stats.entries = 0;
+  stats.bytes = 0;
+}
+
+EnvironmentCacheStats EnvironmentCache::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+}
@@ -0,0 +1,148 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Process-wide cache of loaded environment components.
+ */
+#pragma once
+#include <list>
+#include <memory>
+#include "util/types.hpp"
+#include "util/threads.hpp"
+#include "engine/types.hpp"
+#include "visuals.hpp"
+#include "mechanics.hpp"
+#include "map.hpp"
+
+namespace sky {
+
+/**
+ * Identifies the contents of an environment: its URL, and a checksum of the
+ * file it was loaded from, so an edited file doesn't hit a stale entry.
+ */
+struct EnvironmentKey {
+  EnvironmentKey(const EnvironmentURL &url, const uint32_t checksum);
+
+  EnvironmentURL url;
+  uint32_t checksum;
+
+  bool operator==(const EnvironmentKey &x) const;
+  bool operator<(const EnvironmentKey &x) const;
+};
+
+/**
+ * Hit / miss counters of an EnvironmentCache.
+ */
+struct EnvironmentCacheStats {
+  EnvironmentCacheStats();
+
+  size_t hits, misses, evictions;
+  size_t entries, bytes;
+
+  std::string print() const;
+};
+
+/**
+ * LRU cache of immutable Map, Visuals and Mechanics components, shared by
+ * every Environment that loads the same file. Components are handed out by
+ * shared_ptr, so eviction never pulls them from under a Sky that uses them.
+ *
+ * Entries are charged for an estimate of the memory their components hold,
+ * and the least recently used are evicted when the total exceeds the limit.
+ * Thread-safe: Environments query it from their worker threads.
+ */
+class EnvironmentCache {
+ private:
+  struct Entry {
+    Entry(const EnvironmentKey &key);
+
+    EnvironmentKey key;
+    std::shared_ptr<const Map> map;
+    std::shared_ptr<const Visuals> visuals;
+    std::shared_ptr<const Mechanics> mechanics;
+    size_t bytes;
+  };
+
+  mutable std::mutex mutex;
+  size_t byteLimit;
+  std::list<Entry> entries; // Most recently used first.
+  std::map<EnvironmentKey, std::list<Entry>::iterator> index;
+  EnvironmentCacheStats stats;
+
+  // Find an entry and mark it as used -- mutex must be held.
+  Entry *touch(const EnvironmentKey &key);
+  Entry &touchOrCreate(const EnvironmentKey &key);
+  void evict();
+
+  template<typename Component>
+  std::shared_ptr<const Component> lookup(
+      const EnvironmentKey &key,
+      std::shared_ptr<const Component> Entry::*component) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (Entry *entry = touch(key)) {
+      if (const auto found = entry->*component) {
+        stats.hits++;
+        return found;
+      }
+    }
+    stats.misses++;
+    return nullptr;
+  }
+
+  template<typename Component>
+  void insert(const EnvironmentKey &key,
+              std::shared_ptr<const Component> Entry::*component,
+              const std::shared_ptr<const Component> &value,
+              const size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry &entry = touchOrCreate(key);
+    if (!(entry.*component)) {
+      entry.*component = value;
+      entry.bytes += bytes;
+      stats.bytes += bytes;
+    }
+    evict();
+  }
+
+ public:
+  EnvironmentCache(const size_t byteLimit = 64 * 1024 * 1024);
+  EnvironmentCache(const EnvironmentCache &) = delete;
+
+  // The cache shared by the whole process.
+  static EnvironmentCache &global();
+
+  // Looking up components; nullptr on a miss.
+  std::shared_ptr<const Map> getMap(const EnvironmentKey &key);
+  std::shared_ptr<const Visuals> getVisuals(const EnvironmentKey &key);
+  std::shared_ptr<const Mechanics> getMechanics(const EnvironmentKey &key);
+
+  // Adding freshly loaded components.
+  void putMap(const EnvironmentKey &key,
+              const std::shared_ptr<const Map> &map);
+  void putVisuals(const EnvironmentKey &key,
+                  const std::shared_ptr<const Visuals> &visuals);
+  void putMechanics(const EnvironmentKey &key,
+                    const std::shared_ptr<const Mechanics> &mechanics);
+
+  // Management.
+  void setByteLimit(const size_t limit);
+  void clear();
+  EnvironmentCacheStats getStats() const;
+
+};
+
+}
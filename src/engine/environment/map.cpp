@@ -15,15 +15,53 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <list>
 #include <polypartition.hpp>
 #include "map.hpp"
+#include "skymap.hpp"
+#include "util/mappedfile.hpp"
 #include "util/methods.hpp"
 #include "util/printer.hpp"
 
 namespace sky {
 
+namespace {
+
+// Compiled records for the parts of a Map that aren't flat arrays already.
+struct ObstacleRecord {
+  float x, y, damage;
+  uint32_t firstVertex, vertexCount, firstTriangle, triangleCount;
+};
+
+struct SpawnPointRecord {
+  float x, y, angle;
+  int32_t team;
+};
+
+// Whether [first, first + count) lies within a range of a given size.
+bool inRange(const uint32_t first, const uint32_t count, const size_t size) {
+  return first <= size and count <= size - first;
+}
+
+// Whether a triangle is one Box2D can make a fixture from. b2PolygonShape
+// welds points closer than half its linear slop (a quarter unit at our
+// physics scale) and asserts on what's left if it isn't a proper triangle,
+// so we want every side and the area comfortably clear of zero.
+bool solidTriangle(const sf::Vector2f &a, const sf::Vector2f &b,
+                   const sf::Vector2f &c) {
+  const auto ab = b - a, bc = c - b, ca = a - c;
+  const auto shortest = std::min({ab.x * ab.x + ab.y * ab.y,
+                                  bc.x * bc.x + bc.y * bc.y,
+                                  ca.x * ca.x + ca.y * ca.y});
+  const float doubleArea = std::abs(ab.x * ca.y - ab.y * ca.x);
+  return shortest >= 1 and doubleArea >= 2;
+}
+
+}
+
 /**
  * SpawnPoint.
  */
@@ -40,7 +78,40 @@ SpawnPoint::SpawnPoint() : pos(), angle(0), team(sky::Team::Spectator) { }
 MapObstacle::MapObstacle(const sf::Vector2f &pos,
                          const std::vector<sf::Vector2f> &localVertices,
                          const float damage) :
-    pos(pos), localVertices(localVertices), damage(damage) { }
+    pos(pos), localVertices(localVertices), damage(damage) {
+  triangulate();
+}
+
+void MapObstacle::triangulate() {
+  triangles.clear();
+  if (localVertices.size() < 3 or localVertices.size() > 0xffff) return;
+
+  std::vector<sf::Vector2f> verts(localVertices);
+  pp::Poly poly(verts);
+  poly.SetOrientation(TPPL_CCW);
+  std::list<pp::Poly> pieces;
+  pp::Partition part;
+  if (!part.Triangulate_EC(&poly, &pieces)) return;
+
+  // polypartition hands back points; find them again in localVertices.
+  std::map<std::pair<float, float>, uint16_t> index;
+  for (size_t i = 0; i < localVertices.size(); ++i)
+    index.emplace(std::make_pair(localVertices[i].x, localVertices[i].y),
+                  uint16_t(i));
+  for (const auto &piece : pieces) {
+    // Slivers from collinear outline points hold no area; leave them out.
+    if (piece.GetNumPoints() != 3 or !solidTriangle(
+        piece.GetPoint(0), piece.GetPoint(1), piece.GetPoint(2))) continue;
+    for (const auto &point : piece.GetPoints()) {
+      const auto found = index.find(std::make_pair(point.x, point.y));
+      if (found == index.end()) {
+        triangles.clear();
+        return;
+      }
+      triangles.push_back(found->second);
+    }
+  }
+}
 
 /**
  * MapItem.
@@ -64,12 +135,29 @@ Map::Map(std::istream &stream) :
     loadSuccess = false;
     return;
   }
+  // Only obstacles built by cereal still need their triangulation.
+  for (auto &obstacle : obstacles) obstacle.triangulate();
+  deriveGeometry();
+}
+
+void Map::deriveGeometry() {
+  geometry = MapGeometry(obstacles);
 }
 
 Map::Map() :
     dimensions(1600, 900),
     loadSuccess(true) { }
 
+Map::Map(const sf::Vector2f &dimensions,
+         const std::vector<MapObstacle> &obstacles,
+         const std::vector<SpawnPoint> &spawnPoints) :
+    dimensions(dimensions),
+    obstacles(obstacles),
+    spawnPoints(spawnPoints),
+    loadSuccess(true) {
+  deriveGeometry();
+}
+
 const sf::Vector2f &Map::getDimensions() const {
   return dimensions;
 }
@@ -86,8 +174,28 @@ const std::vector<SpawnPoint> &Map::getSpawnPoints() const {
   return spawnPoints;
 }
 
+const MapGeometry &Map::getGeometry() const {
+  return geometry;
+}
+
+size_t Map::residentBytes() const {
+  size_t bytes = sizeof(Map) + geometry.residentBytes()
+      + obstacles.capacity() * sizeof(MapObstacle)
+      + spawnPoints.capacity() * sizeof(SpawnPoint)
+      + items.capacity() * sizeof(MapItem);
+  for (const auto &obstacle : obstacles) {
+    bytes += obstacle.localVertices.capacity() * sizeof(sf::Vector2f)
+        + obstacle.triangles.capacity() * sizeof(uint16_t);
+  }
+  return bytes;
+}
+
 const SpawnPoint Map::pickSpawnPoint(const Team team) const {
   if (spawnPoints.size() > 0) {
+    // Don't spawn planes inside obstacles, if we have the choice.
+    for (const auto &spawnPoint : spawnPoints) {
+      if (!geometry.insideObstacle(spawnPoint.pos)) return spawnPoint;
+    }
     return spawnPoints[0];
   } else {
     return SpawnPoint({200, 200}, 0, team); // default
@@ -105,5 +213,116 @@ optional<Map> Map::load(std::istream &stream) {
   else return {};
 }
 
+std::string Map::saveCompiled() const {
+  std::vector<ObstacleRecord> obstacleRecords;
+  std::vector<sf::Vector2f> vertices;
+  std::vector<uint16_t> triangles;
+  for (const auto &obstacle : obstacles) {
+    obstacleRecords.push_back(
+        {obstacle.pos.x, obstacle.pos.y, obstacle.damage,
+         uint32_t(vertices.size()), uint32_t(obstacle.localVertices.size()),
+         uint32_t(triangles.size()), uint32_t(obstacle.triangles.size())});
+    vertices.insert(vertices.end(), obstacle.localVertices.begin(),
+                    obstacle.localVertices.end());
+    triangles.insert(triangles.end(), obstacle.triangles.begin(),
+                     obstacle.triangles.end());
+  }
+
+  std::vector<SpawnPointRecord> spawnRecords;
+  for (const auto &spawnPoint : spawnPoints) {
+    spawnRecords.push_back({spawnPoint.pos.x, spawnPoint.pos.y,
+                            float(spawnPoint.angle),
+                            int32_t(spawnPoint.team)});
+  }
+
+  skymap::Writer writer;
+  writer.write(dimensions);
+  writer.writeArray(obstacleRecords);
+  writer.writeArray(vertices);
+  writer.writeArray(triangles);
+  writer.writeArray(spawnRecords);
+  geometry.writeCompiled(writer);
+  return writer.finish();
 }
 
+optional<Map> Map::loadCompiled(const char *data, const size_t size) {
+  skymap::Reader reader(data, size);
+  Map map;
+  std::vector<ObstacleRecord> obstacleRecords;
+  std::vector<sf::Vector2f> vertices;
+  std::vector<uint16_t> triangles;
+  std::vector<SpawnPointRecord> spawnRecords;
+
+  bool valid = reader.read(map.dimensions)
+      and reader.readArray(obstacleRecords)
+      and reader.readArray(vertices)
+      and reader.readArray(triangles)
+      and reader.readArray(spawnRecords)
+      and map.geometry.readCompiled(reader, obstacleRecords.size())
+      and reader.atEnd();
+
+  if (valid) {
+    map.obstacles.reserve(obstacleRecords.size());
+    for (const auto &record : obstacleRecords) {
+      if (!inRange(record.firstVertex, record.vertexCount, vertices.size())
+          or !inRange(record.firstTriangle, record.triangleCount,
+                      triangles.size())
+          or record.triangleCount % 3 != 0) {
+        valid = false;
+        break;
+      }
+
+      const auto firstVertex = vertices.begin() + record.firstVertex;
+      map.obstacles.emplace_back();
+      MapObstacle &obstacle = map.obstacles.back();
+      obstacle.pos = {record.x, record.y};
+      obstacle.damage = record.damage;
+      obstacle.localVertices.assign(firstVertex,
+                                    firstVertex + record.vertexCount);
+
+      const auto firstTriangle = triangles.begin() + record.firstTriangle;
+      obstacle.triangles.assign(firstTriangle,
+                                firstTriangle + record.triangleCount);
+      for (const uint16_t index : obstacle.triangles) {
+        if (index >= record.vertexCount) valid = false;
+      }
+      if (!valid) break;
+      const auto &local = obstacle.localVertices;
+      for (size_t i = 0; i < obstacle.triangles.size(); i += 3) {
+        if (!solidTriangle(local[obstacle.triangles[i]],
+                           local[obstacle.triangles[i + 1]],
+                           local[obstacle.triangles[i + 2]])) {
+          valid = false;
+          break;
+        }
+      }
+      if (!valid) break;
+    }
+
+    for (const auto &record : spawnRecords) {
+      if (record.team < 0 or record.team >= int32_t(Team::MAX)) {
+        valid = false;
+        break;
+      }
+      map.spawnPoints.emplace_back(sf::Vector2f(record.x, record.y),
+                                   record.angle, Team(record.team));
+    }
+  }
+
+  if (!valid) {
+    appLog("Failed to read compiled map!", LogOrigin::Engine);
+    return {};
+  }
+  return map;
+}
+
+optional<Map> Map::loadCompiled(const fs::path &path) {
+  MappedFile file;
+  if (!file.open(path)) {
+    appLog("Could not open compiled map " + path.string(), LogOrigin::Error);
+    return {};
+  }
+  return loadCompiled(file.data(), file.size());
+}
+
+}
@@ -25,7 +25,9 @@
 #include <istream>
 #include <cereal/cereal.hpp>
 #include "util/types.hpp"
+#include "util/filepath.hpp"
 #include "engine/types.hpp"
+#include "mapgeometry.hpp"
 
 namespace sky {
 
@@ -64,6 +66,11 @@ struct MapObstacle {
   std::vector<sf::Vector2f> localVertices;
   float damage;
 
+  // Triangulation for Physics, as triples of indices into localVertices.
+  // Derived when loading, not part of the authored map.
+  std::vector<uint16_t> triangles;
+  void triangulate();
+
   template<typename Archive>
   void serialize(Archive &ar) {
     ar(cereal::make_nvp("pos", pos),
@@ -103,10 +110,17 @@ struct Map {
   std::vector<MapItem> items;
   bool loadSuccess;
 
+  // Derived from obstacles after loading.
+  MapGeometry geometry;
+
   Map(std::istream &s);
+  void deriveGeometry();
 
  public:
   Map(); // null map
+  Map(const sf::Vector2f &dimensions,
+      const std::vector<MapObstacle> &obstacles,
+      const std::vector<SpawnPoint> &spawnPoints);
   Map(const Map &map) = default;
   Map(Map &&map) = default;
 
@@ -122,12 +136,20 @@ struct Map {
   const std::vector<MapObstacle> &getObstacles() const;
   const std::vector<MapItem> &getItems() const;
   const std::vector<SpawnPoint> &getSpawnPoints() const;
+  const MapGeometry &getGeometry() const;
   const SpawnPoint pickSpawnPoint(const Team team) const;
+  // Estimate of the memory the map holds on to, for caching.
+  size_t residentBytes() const;
 
   // Safe reading / saving from / to streams.
   void save(std::ostream &s);
   static optional<Map> load(std::istream &s);
 
+  // The compiled .skymap format, see skymap.hpp.
+  std::string saveCompiled() const;
+  static optional<Map> loadCompiled(const char *data, const size_t size);
+  static optional<Map> loadCompiled(const fs::path &path);
+
 };
 
 }
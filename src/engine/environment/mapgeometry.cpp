@@ -0,0 +1,386 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include "mapgeometry.hpp"
+#include "map.hpp"
+#include "skymap.hpp"
+#include "util/methods.hpp"
+
+namespace sky {
+
+namespace {
+
+float cross(const sf::Vector2f &x, const sf::Vector2f &y) {
+  return x.x * y.y - x.y * y.x;
+}
+
+float dot(const sf::Vector2f &x, const sf::Vector2f &y) {
+  return x.x * y.x + x.y * y.y;
+}
+
+sf::Vector2f invertDir(const sf::Vector2f &dir) {
+  // Large rather than infinite, so 0 * inv stays 0 for axis-aligned rays.
+  const auto inv = [](const float x) { return x == 0 ? 1e30f : 1 / x; };
+  return {inv(dir.x), inv(dir.y)};
+}
+
+float segmentDistance(const sf::Vector2f &point,
+                      const sf::Vector2f &a, const sf::Vector2f &b) {
+  const sf::Vector2f ab = b - a;
+  const float lengthSq = dot(ab, ab);
+  const float t = lengthSq == 0 ? 0 :
+                  clamp(0.0f, 1.0f, dot(point - a, ab) / lengthSq);
+  return VecMath::length(point - (a + t * ab));
+}
+
+}
+
+/**
+ * AABB.
+ */
+
+AABB::AABB() :
+    min(std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::infinity()),
+    max(-std::numeric_limits<float>::infinity(),
+        -std::numeric_limits<float>::infinity()) { }
+
+AABB::AABB(const sf::Vector2f &min, const sf::Vector2f &max) :
+    min(min), max(max) { }
+
+void AABB::extend(const sf::Vector2f &point) {
+  min = {std::min(min.x, point.x), std::min(min.y, point.y)};
+  max = {std::max(max.x, point.x), std::max(max.y, point.y)};
+}
+
+void AABB::extend(const AABB &box) {
+  extend(box.min);
+  extend(box.max);
+}
+
+sf::Vector2f AABB::center() const {
+  return (min + max) / 2.0f;
+}
+
+bool AABB::overlaps(const AABB &box) const {
+  return min.x <= box.max.x and box.min.x <= max.x
+      and min.y <= box.max.y and box.min.y <= max.y;
+}
+
+bool AABB::contains(const sf::Vector2f &point) const {
+  return min.x <= point.x and point.x <= max.x
+      and min.y <= point.y and point.y <= max.y;
+}
+
+float AABB::distance(const sf::Vector2f &point) const {
+  const float dx = std::max(0.0f, std::max(min.x - point.x, point.x - max.x)),
+      dy = std::max(0.0f, std::max(min.y - point.y, point.y - max.y));
+  return std::sqrt(dx * dx + dy * dy);
+}
+
+bool AABB::crossedBy(const sf::Vector2f &from, const sf::Vector2f &invDir,
+                     const float maxT) const {
+  const float tx1 = (min.x - from.x) * invDir.x,
+      tx2 = (max.x - from.x) * invDir.x,
+      ty1 = (min.y - from.y) * invDir.y,
+      ty2 = (max.y - from.y) * invDir.y;
+  const float enter = std::max(std::min(tx1, tx2), std::min(ty1, ty2)),
+      exit = std::min(std::max(tx1, tx2), std::max(ty1, ty2));
+  return exit >= std::max(enter, 0.0f) and enter <= maxT;
+}
+
+/**
+ * StaticBVH.
+ */
+
+unsigned int StaticBVH::build(const std::vector<AABB> &boxes,
+                              const unsigned int begin,
+                              const unsigned int end) {
+  const unsigned int index = (unsigned int) nodes.size();
+  nodes.push_back({});
+
+  AABB box, centers;
+  for (unsigned int i = begin; i < end; ++i) {
+    box.extend(boxes[primitives[i]]);
+    centers.extend(boxes[primitives[i]].center());
+  }
+  nodes[index].box = box;
+
+  if (end - begin <= leafSize) {
+    nodes[index].index = begin;
+    nodes[index].count = end - begin;
+    return index;
+  }
+
+  // Median split along the widest spread of centers.
+  const bool alongX =
+      (centers.max.x - centers.min.x) >= (centers.max.y - centers.min.y);
+  const unsigned int mid = begin + (end - begin) / 2;
+  std::nth_element(
+      primitives.begin() + begin, primitives.begin() + mid,
+      primitives.begin() + end,
+      [&](const unsigned int x, const unsigned int y) {
+        const auto cx = boxes[x].center(), cy = boxes[y].center();
+        return alongX ? cx.x < cy.x : cx.y < cy.y;
+      });
+
+  build(boxes, begin, mid); // Left child lands at index + 1.
+  const unsigned int right = build(boxes, mid, end);
+  nodes[index].index = right;
+  nodes[index].count = 0;
+  return index;
+}
+
+StaticBVH::StaticBVH(const std::vector<AABB> &boxes) {
+  if (boxes.empty()) return;
+  primitives.resize(boxes.size());
+  for (unsigned int i = 0; i < boxes.size(); ++i) primitives[i] = i;
+  nodes.reserve(2 * boxes.size() / leafSize + 1);
+  build(boxes, 0, (unsigned int) boxes.size());
+}
+
+size_t StaticBVH::nodeCount() const {
+  return nodes.size();
+}
+
+size_t StaticBVH::residentBytes() const {
+  return nodes.capacity() * sizeof(Node)
+      + primitives.capacity() * sizeof(unsigned int);
+}
+
+void StaticBVH::writeCompiled(skymap::Writer &writer) const {
+  writer.writeArray(nodes);
+  writer.writeArray(primitives);
+}
+
+bool StaticBVH::readCompiled(skymap::Reader &reader,
+                             const size_t primitiveCount) {
+  if (!reader.readArray(nodes) or !reader.readArray(primitives)) return false;
+  if (nodes.empty() != primitives.empty()) return reader.fail();
+
+  for (const unsigned int p : primitives) {
+    if (p >= primitiveCount) return reader.fail();
+  }
+
+  // Children always come after their parent, and the tree is shallow enough
+  // for traverse()'s stack.
+  std::vector<unsigned int> depth(nodes.size(), 0);
+  if (!nodes.empty()) depth[0] = 1;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const Node &node = nodes[i];
+    if (depth[i] == 0 or depth[i] > 62) return reader.fail();
+    if (node.count > 0) {
+      if (node.index > primitives.size()
+          or node.count > primitives.size() - node.index)
+        return reader.fail();
+    } else {
+      if (i + 1 >= nodes.size() or node.index <= i + 1
+          or node.index >= nodes.size())
+        return reader.fail();
+      depth[i + 1] = depth[node.index] = depth[i] + 1;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * MapGeometry.
+ */
+
+bool MapGeometry::polygonContains(const size_t obstacle,
+                                  const sf::Vector2f &point) const {
+  // Crossing number, so non-convex obstacles work too.
+  const sf::Vector2f *polygon = polygonVertices.data() + polygonStarts[obstacle];
+  const size_t count = polygonStarts[obstacle + 1] - polygonStarts[obstacle];
+  bool inside = false;
+  for (size_t i = 0, j = count - 1; i < count; j = i++) {
+    const sf::Vector2f &a = polygon[i], &b = polygon[j];
+    if ((a.y > point.y) != (b.y > point.y)
+        and point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+      inside = !inside;
+  }
+  return inside;
+}
+
+MapGeometry::MapGeometry(const std::vector<MapObstacle> &obstacles) {
+  std::vector<AABB> edgeBoxes;
+  polygonStarts.push_back(0);
+  for (size_t i = 0; i < obstacles.size(); ++i) {
+    const auto &obstacle = obstacles[i];
+    const size_t start = polygonVertices.size(),
+        count = obstacle.localVertices.size();
+    AABB polygonBox;
+    for (const auto &vertex : obstacle.localVertices) {
+      polygonVertices.push_back(obstacle.pos + vertex);
+      polygonBox.extend(polygonVertices.back());
+    }
+
+    for (size_t v = 0; v < count; ++v) {
+      const Edge edge{polygonVertices[start + v],
+                      polygonVertices[start + (v + 1) % count],
+                      (unsigned int) i};
+      AABB edgeBox;
+      edgeBox.extend(edge.a);
+      edgeBox.extend(edge.b);
+      edges.push_back(edge);
+      edgeBoxes.push_back(edgeBox);
+    }
+
+    polygonStarts.push_back((unsigned int) polygonVertices.size());
+    polygonBoxes.push_back(polygonBox);
+  }
+
+  edgeTree = StaticBVH(edgeBoxes);
+  obstacleTree = StaticBVH(polygonBoxes);
+}
+
+optional<RayHit> MapGeometry::castRay(const sf::Vector2f &from,
+                                      const sf::Vector2f &to) const {
+  const sf::Vector2f dir = to - from, invDir = invertDir(dir);
+  optional<RayHit> nearest;
+  float best = 1;
+
+  edgeTree.traverse(
+      [&](const AABB &box) { return box.crossedBy(from, invDir, best); },
+      [&](const unsigned int e) {
+        const Edge &edge = edges[e];
+        const sf::Vector2f s = edge.b - edge.a;
+        const float denom = cross(dir, s);
+        if (denom == 0) return true;
+        const float t = cross(edge.a - from, s) / denom,
+            u = cross(edge.a - from, dir) / denom;
+        if (t >= 0 and t <= best and u >= 0 and u <= 1) {
+          best = t;
+          sf::Vector2f normal(-s.y, s.x);
+          if (dot(normal, dir) > 0) normal = -normal;
+          nearest = RayHit{t, from + t * dir,
+                           normal / VecMath::length(normal), edge.obstacle};
+        }
+        return true;
+      });
+
+  return nearest;
+}
+
+void MapGeometry::castRays(
+    const std::vector<std::pair<sf::Vector2f, sf::Vector2f>> &rays,
+    std::vector<optional<RayHit>> &hits) const {
+  hits.resize(rays.size());
+  for (size_t i = 0; i < rays.size(); ++i)
+    hits[i] = castRay(rays[i].first, rays[i].second);
+}
+
+bool MapGeometry::lineOfSight(const sf::Vector2f &from,
+                              const sf::Vector2f &to) const {
+  const sf::Vector2f dir = to - from, invDir = invertDir(dir);
+  bool clear = true;
+
+  edgeTree.traverse(
+      [&](const AABB &box) { return box.crossedBy(from, invDir, 1); },
+      [&](const unsigned int e) {
+        const Edge &edge = edges[e];
+        const sf::Vector2f s = edge.b - edge.a;
+        const float denom = cross(dir, s);
+        if (denom == 0) return true;
+        const float t = cross(edge.a - from, s) / denom,
+            u = cross(edge.a - from, dir) / denom;
+        clear = !(t >= 0 and t <= 1 and u >= 0 and u <= 1);
+        return clear;
+      });
+
+  return clear;
+}
+
+bool MapGeometry::insideObstacle(const sf::Vector2f &point) const {
+  bool inside = false;
+  obstacleTree.traverse(
+      [&](const AABB &box) { return box.contains(point); },
+      [&](const unsigned int o) {
+        inside = polygonBoxes[o].contains(point) and polygonContains(o, point);
+        return !inside;
+      });
+  return inside;
+}
+
+float MapGeometry::nearestDistance(const sf::Vector2f &point,
+                                   const float limit) const {
+  float best = limit;
+  edgeTree.traverse(
+      [&](const AABB &box) { return box.distance(point) < best; },
+      [&](const unsigned int e) {
+        best = std::min(best, segmentDistance(point, edges[e].a, edges[e].b));
+        return true;
+      });
+  return best;
+}
+
+void MapGeometry::queryBox(const AABB &box,
+                           std::vector<size_t> &obstacles) const {
+  obstacleTree.traverse(
+      [&](const AABB &node) { return node.overlaps(box); },
+      [&](const unsigned int o) {
+        if (polygonBoxes[o].overlaps(box)) obstacles.push_back(o);
+        return true;
+      });
+}
+
+size_t MapGeometry::residentBytes() const {
+  return edges.capacity() * sizeof(Edge) + edgeTree.residentBytes()
+      + polygonVertices.capacity() * sizeof(sf::Vector2f)
+      + polygonStarts.capacity() * sizeof(unsigned int)
+      + polygonBoxes.capacity() * sizeof(AABB)
+      + obstacleTree.residentBytes();
+}
+
+void MapGeometry::writeCompiled(skymap::Writer &writer) const {
+  writer.writeArray(edges);
+  edgeTree.writeCompiled(writer);
+  writer.writeArray(polygonVertices);
+  writer.writeArray(polygonStarts);
+  writer.writeArray(polygonBoxes);
+  obstacleTree.writeCompiled(writer);
+}
+
+bool MapGeometry::readCompiled(skymap::Reader &reader,
+                               const size_t obstacleCount) {
+  if (!reader.readArray(edges)
+      or !edgeTree.readCompiled(reader, edges.size())
+      or !reader.readArray(polygonVertices)
+      or !reader.readArray(polygonStarts)
+      or !reader.readArray(polygonBoxes)
+      or !obstacleTree.readCompiled(reader, obstacleCount))
+    return false;
+
+  if (polygonStarts.empty()) polygonStarts.push_back(0); // Null map.
+  if (polygonStarts.size() != obstacleCount + 1
+      or polygonBoxes.size() != obstacleCount
+      or polygonStarts.front() != 0
+      or polygonStarts.back() != polygonVertices.size())
+    return reader.fail();
+  for (size_t i = 0; i < obstacleCount; ++i) {
+    if (polygonStarts[i] >= polygonStarts[i + 1]) return reader.fail();
+  }
+  for (const Edge &edge : edges) {
+    if (edge.obstacle >= obstacleCount) return reader.fail();
+  }
+
+  return true;
+}
+
+}
@@ -0,0 +1,176 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Static acceleration structures over Map geometry.
+ */
+#pragma once
+#include <limits>
+#include "util/types.hpp"
+
+namespace sky {
+
+struct MapObstacle;
+
+namespace skymap {
+class Writer;
+class Reader;
+}
+
+/**
+ * Axis-aligned bounding box.
+ */
+struct AABB {
+  AABB(); // empty, contains nothing
+  AABB(const sf::Vector2f &min, const sf::Vector2f &max);
+
+  sf::Vector2f min, max;
+
+  void extend(const sf::Vector2f &point);
+  void extend(const AABB &box);
+  sf::Vector2f center() const;
+
+  bool overlaps(const AABB &box) const;
+  bool contains(const sf::Vector2f &point) const;
+  float distance(const sf::Vector2f &point) const;
+  // Whether the segment from + t * dir for t in [0, maxT] touches the box.
+  bool crossedBy(const sf::Vector2f &from, const sf::Vector2f &invDir,
+                 const float maxT) const;
+
+};
+
+/**
+ * Bounding-volume hierarchy over a fixed set of boxes, stored flat in
+ * depth-first order. Built once; read-only afterwards, so any number of
+ * threads can query it at once.
+ */
+class StaticBVH {
+ private:
+  struct Node {
+    AABB box;
+    unsigned int index, // leaf: first primitive; inner: right child
+        count; // primitives in a leaf, 0 for inner nodes
+  };
+
+  std::vector<Node> nodes;
+  std::vector<unsigned int> primitives; // Indices into the boxes we're built on.
+
+  unsigned int build(const std::vector<AABB> &boxes,
+                     const unsigned int begin, const unsigned int end);
+
+ public:
+  StaticBVH() = default;
+  StaticBVH(const std::vector<AABB> &boxes);
+
+  static constexpr unsigned int leafSize = 4;
+
+  /**
+   * Visit the primitives in every node whose box passes `enter`, until
+   * `visit` returns false.
+   */
+  template<typename Enter, typename Visit>
+  void traverse(Enter enter, Visit visit) const {
+    if (nodes.empty()) return;
+    unsigned int stack[64], top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+      const unsigned int i = stack[--top];
+      const Node &node = nodes[i];
+      if (!enter(node.box)) continue;
+      if (node.count > 0) {
+        for (unsigned int p = node.index; p < node.index + node.count; ++p)
+          if (!visit(primitives[p])) return;
+      } else {
+        stack[top++] = node.index;
+        stack[top++] = i + 1;
+      }
+    }
+  }
+
+  size_t nodeCount() const;
+  size_t residentBytes() const; // heap storage, roughly
+
+  // Compiled map IO. Reading checks the tree is well-formed over a number
+  // of primitives, so traversal stays in bounds.
+  void writeCompiled(skymap::Writer &writer) const;
+  bool readCompiled(skymap::Reader &reader, const size_t primitiveCount);
+
+};
+
+/**
+ * Where a ray met an obstacle.
+ */
+struct RayHit {
+  float fraction; // along the ray
+  sf::Vector2f point, normal;
+  size_t obstacle; // index into the Map's obstacles
+};
+
+/**
+ * Query interface to the static obstacles of a Map, independent of Physics.
+ * Obstacle edges are held in one BVH, whole obstacles in another.
+ */
+class MapGeometry {
+ private:
+  struct Edge {
+    sf::Vector2f a, b;
+    unsigned int obstacle;
+  };
+
+  std::vector<Edge> edges;
+  StaticBVH edgeTree;
+
+  // Obstacle outlines in world coordinates, one after the other;
+  // polygon i is [polygonStarts[i], polygonStarts[i + 1]).
+  std::vector<sf::Vector2f> polygonVertices;
+  std::vector<unsigned int> polygonStarts;
+  std::vector<AABB> polygonBoxes;
+  StaticBVH obstacleTree;
+
+  bool polygonContains(const size_t obstacle, const sf::Vector2f &point) const;
+
+ public:
+  MapGeometry() = default;
+  MapGeometry(const std::vector<MapObstacle> &obstacles);
+
+  // Nearest obstacle edge crossed by the segment from `from` to `to`.
+  optional<RayHit> castRay(const sf::Vector2f &from,
+                           const sf::Vector2f &to) const;
+  void castRays(
+      const std::vector<std::pair<sf::Vector2f, sf::Vector2f>> &rays,
+      std::vector<optional<RayHit>> &hits) const;
+
+  // Whether nothing stands between two points; stops at the first edge.
+  bool lineOfSight(const sf::Vector2f &from, const sf::Vector2f &to) const;
+
+  bool insideObstacle(const sf::Vector2f &point) const;
+  // Distance to the nearest obstacle edge, up to a limit.
+  float nearestDistance(
+      const sf::Vector2f &point,
+      const float limit = std::numeric_limits<float>::infinity()) const;
+  // Indices of obstacles whose bounds overlap a box.
+  void queryBox(const AABB &box, std::vector<size_t> &obstacles) const;
+
+  size_t residentBytes() const; // heap storage, roughly
+
+  // Compiled map IO.
+  void writeCompiled(skymap::Writer &writer) const;
+  bool readCompiled(skymap::Reader &reader, const size_t obstacleCount);
+
+};
+
+}
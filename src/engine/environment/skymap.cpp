@@ -0,0 +1,81 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <zlib.h>
+#include "skymap.hpp"
+
+namespace sky {
+
+namespace skymap {
+
+namespace {
+
+uint32_t checksum(const char *data, const size_t size) {
+  return uint32_t(crc32(0, reinterpret_cast<const Bytef *>(data), uInt(size)));
+}
+
+}
+
+/**
+ * Writer.
+ */
+
+std::string Writer::finish() const {
+  std::string file(magic, sizeof(magic));
+  const uint32_t fields[] = {version, uint32_t(body.size()),
+                             checksum(body.data(), body.size())};
+  file.append(reinterpret_cast<const char *>(fields), sizeof(fields));
+  return file + body;
+}
+
+/**
+ * Reader.
+ */
+
+Reader::Reader(const char *data, const size_t size) :
+    body(nullptr),
+    bodySize(0),
+    cursor(0),
+    ok(false) {
+  if (size < headerSize or std::memcmp(data, magic, sizeof(magic)) != 0)
+    return;
+
+  uint32_t fields[3];
+  std::memcpy(fields, data + sizeof(magic), sizeof(fields));
+  if (fields[0] != version or fields[1] != size - headerSize) return;
+  if (fields[2] != checksum(data + headerSize, size - headerSize)) return;
+
+  body = data + headerSize;
+  bodySize = size - headerSize;
+  ok = true;
+}
+
+bool Reader::fail() {
+  return ok = false;
+}
+
+bool Reader::isValid() const {
+  return ok;
+}
+
+bool Reader::atEnd() const {
+  return cursor == bodySize;
+}
+
+}
+
+}
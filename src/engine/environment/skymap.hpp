@@ -0,0 +1,127 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * The compiled .skymap map format.
+ */
+#pragma once
+#include <cstring>
+#include <type_traits>
+#include "util/types.hpp"
+
+namespace sky {
+
+/**
+ * A .skymap holds a Map as flat arrays: obstacles and their vertices, the
+ * triangulation Physics builds fixtures from, spawn points, and the edge
+ * list and BVHs of MapGeometry. Loading doesn't parse anything, but it isn't
+ * zero-copy either: each section is copied out in one block, and then into
+ * the Map's own structures (a vertex and a triangle vector per obstacle),
+ * checking indices and triangles along the way. JSON stays the authoring
+ * format; maps are compiled by solemnsky_mapcompiler.
+ *
+ * Layout: a 20-byte header (magic, version, body size, CRC-32 of the body),
+ * then a body of sections, each a uint32 element count followed by the
+ * elements' bytes, unpadded. Everything is in the compiling host's byte
+ * order, so that sections copy out as they are; a file from a host of the
+ * other endianness fails the version check and falls back to map.json.
+ */
+namespace skymap {
+
+const char magic[8] = {'S', 'K', 'Y', 'M', 'A', 'P', '\r', '\n'};
+const uint32_t version = 1;
+const size_t headerSize = 20;
+
+/**
+ * Builds a .skymap.
+ */
+class Writer {
+ private:
+  std::string body;
+
+ public:
+  Writer() = default;
+
+  template<typename T>
+  void write(const T &x) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "skymap sections hold plain data only");
+    body.append(reinterpret_cast<const char *>(&x), sizeof(T));
+  }
+
+  template<typename T>
+  void writeArray(const std::vector<T> &xs) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "skymap sections hold plain data only");
+    write(uint32_t(xs.size()));
+    if (!xs.empty())
+      body.append(reinterpret_cast<const char *>(xs.data()),
+                  sizeof(T) * xs.size());
+  }
+
+  // The whole file: header and body.
+  std::string finish() const;
+
+};
+
+/**
+ * Reads a .skymap, checking its header up front and every section's bounds
+ * as it goes. Once a read fails, every later one does too.
+ */
+class Reader {
+ private:
+  const char *body;
+  size_t bodySize, cursor;
+  bool ok;
+
+ public:
+  Reader(const char *data, const size_t size);
+
+  template<typename T>
+  bool read(T &x) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "skymap sections hold plain data only");
+    if (!ok or bodySize - cursor < sizeof(T)) return ok = false;
+    std::memcpy(&x, body + cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+  }
+
+  template<typename T>
+  bool readArray(std::vector<T> &xs) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "skymap sections hold plain data only");
+    uint32_t count;
+    if (!read(count)) return false;
+    if ((bodySize - cursor) / sizeof(T) < count) return ok = false;
+    xs.resize(count);
+    if (count > 0) std::memcpy(xs.data(), body + cursor, sizeof(T) * count);
+    cursor += sizeof(T) * count;
+    return true;
+  }
+
+  // Mark the file invalid, when its contents don't add up.
+  bool fail();
+
+  bool isValid() const;
+  bool atEnd() const;
+
+};
+
+}
+
+}
@@ -55,6 +55,10 @@ Entity::Entity(const EntityState &state, Physics &physics) :
   body->SetGravityScale(0);
 }
 
+Entity::~Entity() {
+  physics.deleteBody(body);
+}
+
 EntityState Entity::captureInitializer() const {
   return state;
 }
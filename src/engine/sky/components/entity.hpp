@@ -86,6 +86,7 @@ class Entity: public Component<EntityState, EntityDelta> {
  public:
   Entity() = delete;
   Entity(const EntityState &state, Physics &physics);
+  ~Entity();
 
   // Networked impl.
   EntityState captureInitializer() const override final;
@@ -0,0 +1,408 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "flightbatch.hpp"
+#include "util/methods.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace sky {
+
+namespace {
+
+/**
+ * Lanes: the operations the flight kernel needs, over one float or a
+ * vector register of them. Every lane runs exactly the same IEEE operations,
+ * so the backends agree bit-for-bit with each other.
+ */
+
+struct ScalarLane {
+  using V = float;
+  using M = bool;
+  static constexpr size_t width = 1;
+
+  static V load(const float *x) { return *x; }
+  static void store(float *x, const V v) { *x = v; }
+  static V set(const float x) { return x; }
+
+  static V add(const V x, const V y) { return x + y; }
+  static V sub(const V x, const V y) { return x - y; }
+  static V mul(const V x, const V y) { return x * y; }
+  static V div(const V x, const V y) { return x / y; }
+  static V sqrt(const V x) { return std::sqrt(x); }
+
+  static M gt(const V x, const V y) { return x > y; }
+  static M lt(const V x, const V y) { return x < y; }
+  static M le(const V x, const V y) { return x <= y; }
+  static M eq(const V x, const V y) { return x == y; }
+  static M neq(const V x, const V y) { return x != y; }
+  static M both(const M x, const M y) { return x && y; }
+  static M either(const M x, const M y) { return x || y; }
+  static M andNot(const M x, const M y) { return !x && y; }
+  static M truth(const V x) { return x != 0; }
+  static V fromMask(const M m) { return m ? 1.0f : 0.0f; }
+
+  static V select(const M m, const V x, const V y) { return m ? x : y; }
+};
+
+#if defined(__SSE2__)
+struct SSELane {
+  using V = __m128;
+  using M = __m128;
+  static constexpr size_t width = 4;
+
+  static V load(const float *x) { return _mm_loadu_ps(x); }
+  static void store(float *x, const V v) { _mm_storeu_ps(x, v); }
+  static V set(const float x) { return _mm_set1_ps(x); }
+
+  static V add(const V x, const V y) { return _mm_add_ps(x, y); }
+  static V sub(const V x, const V y) { return _mm_sub_ps(x, y); }
+  static V mul(const V x, const V y) { return _mm_mul_ps(x, y); }
+  static V div(const V x, const V y) { return _mm_div_ps(x, y); }
+  static V sqrt(const V x) { return _mm_sqrt_ps(x); }
+
+  static M gt(const V x, const V y) { return _mm_cmpgt_ps(x, y); }
+  static M lt(const V x, const V y) { return _mm_cmplt_ps(x, y); }
+  static M le(const V x, const V y) { return _mm_cmple_ps(x, y); }
+  static M eq(const V x, const V y) { return _mm_cmpeq_ps(x, y); }
+  static M neq(const V x, const V y) { return _mm_cmpneq_ps(x, y); }
+  static M both(const M x, const M y) { return _mm_and_ps(x, y); }
+  static M either(const M x, const M y) { return _mm_or_ps(x, y); }
+  static M andNot(const M x, const M y) { return _mm_andnot_ps(x, y); }
+  static M truth(const V x) { return _mm_cmpneq_ps(x, _mm_setzero_ps()); }
+  static V fromMask(const M m) { return _mm_and_ps(m, _mm_set1_ps(1.0f)); }
+
+  static V select(const M m, const V x, const V y) {
+    return _mm_or_ps(_mm_and_ps(m, x), _mm_andnot_ps(m, y));
+  }
+};
+#endif
+
+#if defined(__AVX__)
+struct AVXLane {
+  using V = __m256;
+  using M = __m256;
+  static constexpr size_t width = 8;
+
+  static V load(const float *x) { return _mm256_loadu_ps(x); }
+  static void store(float *x, const V v) { _mm256_storeu_ps(x, v); }
+  static V set(const float x) { return _mm256_set1_ps(x); }
+
+  static V add(const V x, const V y) { return _mm256_add_ps(x, y); }
+  static V sub(const V x, const V y) { return _mm256_sub_ps(x, y); }
+  static V mul(const V x, const V y) { return _mm256_mul_ps(x, y); }
+  static V div(const V x, const V y) { return _mm256_div_ps(x, y); }
+  static V sqrt(const V x) { return _mm256_sqrt_ps(x); }
+
+  static M gt(const V x, const V y) { return _mm256_cmp_ps(x, y, _CMP_GT_OQ); }
+  static M lt(const V x, const V y) { return _mm256_cmp_ps(x, y, _CMP_LT_OQ); }
+  static M le(const V x, const V y) { return _mm256_cmp_ps(x, y, _CMP_LE_OQ); }
+  static M eq(const V x, const V y) { return _mm256_cmp_ps(x, y, _CMP_EQ_OQ); }
+  static M neq(const V x, const V y) { return _mm256_cmp_ps(x, y, _CMP_NEQ_UQ); }
+  static M both(const M x, const M y) { return _mm256_and_ps(x, y); }
+  static M either(const M x, const M y) { return _mm256_or_ps(x, y); }
+  static M andNot(const M x, const M y) { return _mm256_andnot_ps(x, y); }
+  static M truth(const V x) {
+    return _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+  }
+  static V fromMask(const M m) { return _mm256_and_ps(m, _mm256_set1_ps(1.0f)); }
+
+  static V select(const M m, const V x, const V y) {
+    return _mm256_blendv_ps(y, x, m);
+  }
+};
+#endif
+
+/**
+ * Helpers over lanes, mirroring the scalar utilities in util/types.hpp.
+ */
+
+template<typename L>
+typename L::V clamp01(const typename L::V x) {
+  return L::select(L::gt(x, L::set(1)), L::set(1),
+                   L::select(L::lt(x, L::set(0)), L::set(0), x));
+}
+
+template<typename L>
+typename L::V sign(const typename L::V x) {
+  return L::select(L::gt(x, L::set(0)), L::set(1),
+                   L::select(L::lt(x, L::set(0)), L::set(-1), L::set(0)));
+}
+
+template<typename L>
+typename L::V approach(const typename L::V x,
+                       const typename L::V target,
+                       const typename L::V amount) {
+  const auto msign = sign<L>(L::sub(target, x));
+  const auto naive = L::add(x, L::mul(msign, amount));
+  return L::select(L::neq(sign<L>(L::sub(target, naive)), msign),
+                   target, naive);
+}
+
+}
+
+/**
+ * FlightBatch.
+ */
+
+template<typename L>
+void FlightBatch::tickLanes(const TimeDiff delta,
+                            const size_t begin, const size_t end) {
+  using V = typename L::V;
+  const V dt = L::set(delta), zero = L::set(0), one = L::set(1);
+
+  for (size_t i = begin; i + L::width <= end; i += L::width) {
+#define LOAD(field) const V field = L::load(&this->field[i])
+    LOAD(cosRot);
+    LOAD(sinRot);
+    LOAD(stallDampingPow);
+    LOAD(leftoverDampingPow);
+    LOAD(throttleCtrl);
+    LOAD(rotCtrl);
+    LOAD(stallMaxRotVel);
+    LOAD(stallMaxVel);
+    LOAD(stallThrust);
+    LOAD(stallThreshold);
+    LOAD(flightMaxRotVel);
+    LOAD(airspeedFactor);
+    LOAD(throttleInfluence);
+    LOAD(throttleEffect);
+    LOAD(throttleBrakeEffect);
+    LOAD(throttleGlideDamper);
+    LOAD(gravityEffect);
+    LOAD(afterburnDrive);
+    LOAD(flightThreshold);
+    LOAD(recharge);
+    LOAD(thrustDrain);
+#undef LOAD
+
+    V vx = L::load(&velX[i]), vy = L::load(&velY[i]),
+        air = L::load(&airspeed[i]), thr = L::load(&throttle[i]),
+        lox = L::load(&leftoverX[i]), loy = L::load(&leftoverY[i]),
+        nrg = L::load(&energy[i]);
+    auto isStalled = L::truth(L::load(&stalled[i]));
+
+    const V speed = L::sqrt(L::add(L::mul(vx, vx), L::mul(vy, vy)));
+    const V forward = L::add(L::mul(vx, cosRot), L::mul(vy, sinRot));
+
+    // Switching stall.
+    const auto leaveStall = L::both(isStalled, L::gt(forward, stallThreshold));
+    const auto enterStall = L::andNot(isStalled, L::lt(forward, flightThreshold));
+    const V breakAirspeed = clamp01<L>(L::div(forward, airspeedFactor));
+    lox = L::select(leaveStall, L::sub(vx, L::mul(forward, cosRot)), lox);
+    loy = L::select(leaveStall, L::sub(vy, L::mul(forward, sinRot)), loy);
+    air = L::select(leaveStall, breakAirspeed, air);
+    thr = L::select(leaveStall,
+                    clamp01<L>(L::div(breakAirspeed, throttleInfluence)), thr);
+    air = L::select(enterStall, zero, air);
+    thr = L::select(enterStall, one, thr);
+    isStalled = L::either(L::andNot(leaveStall, isStalled), enterStall);
+
+    // Rotation and energy.
+    L::store(&rotvel[i], L::mul(L::select(isStalled, stallMaxRotVel,
+                                          flightMaxRotVel), rotCtrl));
+    nrg = clamp01<L>(L::add(nrg, L::mul(recharge, dt)));
+
+    // Afterburner, in both regimes.
+    const auto thrusting = L::eq(throttleCtrl, one);
+    const V flightThrottle =
+        clamp01<L>(L::add(thr, L::mul(throttleCtrl, dt)));
+    const auto stallBurn = L::both(isStalled, thrusting);
+    const auto flightBurn = L::andNot(
+        isStalled, L::both(thrusting, L::eq(flightThrottle, one)));
+    const auto burning = L::either(stallBurn, flightBurn);
+
+    const V request = L::mul(thrustDrain, dt);
+    const V drained = clamp01<L>(L::sub(nrg, request));
+    const V efficacy = L::div(L::sub(nrg, drained), request);
+    nrg = L::select(burning, drained, nrg);
+    L::store(&afterburner[i], L::select(burning, clamp01<L>(efficacy), zero));
+
+    // Stalled regime.
+    const V thrust = L::mul(L::mul(dt, stallThrust), efficacy);
+    V stallVx = L::select(stallBurn, L::add(vx, L::mul(cosRot, thrust)), vx),
+        stallVy = L::select(stallBurn, L::add(vy, L::mul(sinRot, thrust)), vy);
+    const auto excess = L::gt(L::sub(speed, stallMaxVel), zero);
+    const V damping = L::mul(L::div(stallMaxVel, speed), stallDampingPow);
+    stallVx = L::select(excess, L::mul(stallVx, damping), stallVx);
+    stallVy = L::select(excess, L::mul(stallVy, damping), stallVy);
+
+    // Flight regime.
+    const V flightLox = L::mul(lox, leftoverDampingPow),
+        flightLoy = L::mul(loy, leftoverDampingPow);
+    const V speedMod = L::add(
+        L::mul(L::mul(sinRot, gravityEffect), dt),
+        L::select(flightBurn,
+                  L::mul(L::mul(afterburnDrive, dt), efficacy), zero));
+    V flightAir = clamp01<L>(L::add(air, speedMod));
+
+    const V targetThrottle = L::mul(flightThrottle, throttleInfluence);
+    const V effectFactor = L::select(
+        L::either(L::le(flightAir, throttleInfluence),
+                  L::lt(flightThrottle, L::set(0.9f))),
+        one, throttleGlideDamper);
+    const V effect = L::select(L::gt(flightAir, targetThrottle),
+                               throttleBrakeEffect, throttleEffect);
+    flightAir = clamp01<L>(approach<L>(
+        flightAir, targetThrottle, L::mul(L::mul(effect, effectFactor), dt)));
+
+    const V targetSpeed = L::mul(flightAir, airspeedFactor);
+    const V flightVx = L::add(L::mul(targetSpeed, cosRot), flightLox),
+        flightVy = L::add(L::mul(targetSpeed, sinRot), flightLoy);
+
+    // Merge the two regimes.
+    L::store(&velX[i], L::select(isStalled, stallVx, flightVx));
+    L::store(&velY[i], L::select(isStalled, stallVy, flightVy));
+    L::store(&airspeed[i], L::select(isStalled, air, flightAir));
+    L::store(&throttle[i], L::select(isStalled, thr, flightThrottle));
+    L::store(&leftoverX[i], L::select(isStalled, lox, flightLox));
+    L::store(&leftoverY[i], L::select(isStalled, loy, flightLoy));
+    L::store(&energy[i], nrg);
+    L::store(&stalled[i], L::fromMask(isStalled));
+  }
+}
+
+void FlightBatch::prePass(const TimeDiff delta) {
+  const size_t n = size();
+  cosRot.resize(n);
+  sinRot.resize(n);
+  stallDampingPow.resize(n);
+  leftoverDampingPow.resize(n);
+
+  // Planes almost always share tuning values, so we memoize the powers.
+  float lastStall = 0, lastStallPow = 1, lastLeftover = 0, lastLeftoverPow = 1;
+  for (size_t i = 0; i < n; ++i) {
+    const float rad = toRad(rot[i]);
+    cosRot[i] = std::cos(rad);
+    sinRot[i] = std::sin(rad);
+
+    if (i == 0 or stallDamping[i] != lastStall) {
+      lastStall = stallDamping[i];
+      lastStallPow = std::pow(lastStall, delta);
+    }
+    stallDampingPow[i] = lastStallPow;
+
+    if (i == 0 or leftoverDamping[i] != lastLeftover) {
+      lastLeftover = leftoverDamping[i];
+      lastLeftoverPow = std::pow(lastLeftover, delta);
+    }
+    leftoverDampingPow[i] = lastLeftoverPow;
+  }
+}
+
+void FlightBatch::clear() {
+  for (auto *field : {&rot, &velX, &velY, &rotvel, &stalled, &airspeed,
+                      &throttle, &afterburner, &leftoverX, &leftoverY, &energy,
+                      &throttleCtrl, &rotCtrl,
+                      &stallMaxRotVel, &stallMaxVel, &stallThrust,
+                      &stallDamping, &stallThreshold, &flightMaxRotVel,
+                      &airspeedFactor, &throttleInfluence, &throttleEffect,
+                      &throttleBrakeEffect, &throttleGlideDamper,
+                      &gravityEffect, &afterburnDrive, &leftoverDamping,
+                      &flightThreshold, &recharge, &thrustDrain}) {
+    field->clear();
+  }
+}
+
+size_t FlightBatch::size() const {
+  return rot.size();
+}
+
+size_t FlightBatch::push(const PlaneState &state,
+                         const PlaneTuning &tuning,
+                         const PlaneControls &controls) {
+  rot.push_back(state.physical.rot);
+  velX.push_back(state.physical.vel.x);
+  velY.push_back(state.physical.vel.y);
+  rotvel.push_back(state.physical.rotvel);
+  stalled.push_back(state.stalled ? 1 : 0);
+  airspeed.push_back(state.airspeed);
+  throttle.push_back(state.throttle);
+  afterburner.push_back(state.afterburner);
+  leftoverX.push_back(state.leftoverVel.x);
+  leftoverY.push_back(state.leftoverVel.y);
+  energy.push_back(state.energy);
+
+  throttleCtrl.push_back(movementValue(
+      addMovement(controls.getState<Action::Reverse>(),
+                  controls.getState<Action::Thrust>())));
+  rotCtrl.push_back(movementValue(controls.rotMovement()));
+
+  stallMaxRotVel.push_back(tuning.stall.maxRotVel);
+  stallMaxVel.push_back(tuning.stall.maxVel);
+  stallThrust.push_back(tuning.stall.thrust);
+  stallDamping.push_back(tuning.stall.damping);
+  stallThreshold.push_back(tuning.stall.threshold);
+  flightMaxRotVel.push_back(tuning.flight.maxRotVel);
+  airspeedFactor.push_back(tuning.flight.airspeedFactor);
+  throttleInfluence.push_back(tuning.flight.throttleInfluence);
+  throttleEffect.push_back(tuning.flight.throttleEffect);
+  throttleBrakeEffect.push_back(tuning.flight.throttleBrakeEffect);
+  throttleGlideDamper.push_back(tuning.flight.throttleGlideDamper);
+  gravityEffect.push_back(tuning.flight.gravityEffect);
+  afterburnDrive.push_back(tuning.flight.afterburnDrive);
+  leftoverDamping.push_back(tuning.flight.leftoverDamping);
+  flightThreshold.push_back(tuning.flight.threshold);
+  recharge.push_back(tuning.energy.recharge);
+  thrustDrain.push_back(tuning.energy.thrustDrain);
+
+  return rot.size() - 1;
+}
+
+void FlightBatch::pull(const size_t i, PlaneState &state) const {
+  state.physical.vel = {velX[i], velY[i]};
+  state.physical.rotvel = rotvel[i];
+  state.stalled = stalled[i] != 0;
+  state.airspeed = airspeed[i];
+  state.throttle = throttle[i];
+  state.afterburner = afterburner[i];
+  state.leftoverVel = {leftoverX[i], leftoverY[i]};
+  state.energy = energy[i];
+}
+
+void FlightBatch::tick(const TimeDiff delta) {
+  prePass(delta);
+  const size_t n = size();
+  size_t done = 0;
+#if defined(__AVX__)
+  tickLanes<AVXLane>(delta, done, n);
+  done = n - (n % AVXLane::width);
+#elif defined(__SSE2__)
+  tickLanes<SSELane>(delta, done, n);
+  done = n - (n % SSELane::width);
+#endif
+  tickLanes<ScalarLane>(delta, done, n);
+}
+
+void FlightBatch::tickScalar(const TimeDiff delta) {
+  prePass(delta);
+  tickLanes<ScalarLane>(delta, 0, size());
+}
+
+std::string FlightBatch::describeBackend() {
+#if defined(__AVX__)
+  return "AVX";
+#elif defined(__SSE2__)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+}
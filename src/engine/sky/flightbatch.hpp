@@ -0,0 +1,77 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Batched flight model, operating on all spawned planes at once.
+ */
+#pragma once
+#include <vector>
+#include "planestate.hpp"
+
+namespace sky {
+
+/**
+ * Flight-relevant state and tuning of a set of planes, held as
+ * structure-of-arrays so that Plane::tickFlight can be run over all of them
+ * with SIMD kernels (AVX or SSE when compiled in, scalar otherwise).
+ *
+ * Results are tolerance-bounded against Plane::tickFlight; the forward
+ * velocity is computed as a dot product instead of through atan2, and
+ * transcendentals are hoisted out of the per-plane arithmetic.
+ */
+struct FlightBatch {
+ private:
+  // Scratch, filled in the pre-pass of each tick.
+  std::vector<float> cosRot, sinRot, stallDampingPow, leftoverDampingPow;
+
+  template<typename Lane>
+  void tickLanes(const TimeDiff delta, const size_t begin, const size_t end);
+  void prePass(const TimeDiff delta);
+
+ public:
+  FlightBatch() = default;
+
+  // State.
+  std::vector<float> rot, velX, velY, rotvel, stalled,
+      airspeed, throttle, afterburner, leftoverX, leftoverY, energy;
+
+  // Controls, as movement values.
+  std::vector<float> throttleCtrl, rotCtrl;
+
+  // Tuning.
+  std::vector<float> stallMaxRotVel, stallMaxVel, stallThrust, stallDamping,
+      stallThreshold, flightMaxRotVel, airspeedFactor, throttleInfluence,
+      throttleEffect, throttleBrakeEffect, throttleGlideDamper, gravityEffect,
+      afterburnDrive, leftoverDamping, flightThreshold, recharge, thrustDrain;
+
+  // Gathering and scattering.
+  void clear();
+  size_t size() const;
+  size_t push(const PlaneState &state,
+              const PlaneTuning &tuning,
+              const PlaneControls &controls);
+  void pull(const size_t index, PlaneState &state) const;
+
+  // Ticking.
+  void tick(const TimeDiff delta); // Widest backend available.
+  void tickScalar(const TimeDiff delta);
+
+  static std::string describeBackend();
+
+};
+
+}
@@ -63,6 +63,61 @@ BodyTag BodyTag::ZoneTag(Zone &zone) {
   return tag;
 }
 
+/**
+ * TagSlab.
+ */
+
+BodyTag *TagSlab::acquire(const BodyTag &tag) {
+  if (free.empty()) {
+    chunks.emplace_back(new Storage[chunkSize]);
+    for (size_t i = chunkSize; i > 0; --i)
+      free.push_back(&chunks.back()[i - 1]);
+  }
+
+  Storage *storage = free.back();
+  free.pop_back();
+  return new(storage) BodyTag(tag);
+}
+
+void TagSlab::release(BodyTag *const tag) {
+  tag->~BodyTag();
+  free.push_back(reinterpret_cast<Storage *>(tag));
+}
+
+size_t TagSlab::chunkCount() const {
+  return chunks.size();
+}
+
+/**
+ * CollisionFilter.
+ */
+
+uint16 CollisionFilter::category(const BodyTag::Type type) {
+  return uint16(1 << uint16(type));
+}
+
+uint16 CollisionFilter::mask(const BodyTag::Type type) {
+  switch (type) {
+    case BodyTag::Type::Plane:
+      // Planes pass through each other.
+      return uint16(0xFFFF & ~category(BodyTag::Type::Plane));
+    case BodyTag::Type::Boundary:
+    case BodyTag::Type::Obstacle:
+    case BodyTag::Type::Entity:
+    case BodyTag::Type::HomeBase:
+    case BodyTag::Type::Zone:
+      return 0xFFFF;
+  }
+  throw enum_error();
+}
+
+b2Filter CollisionFilter::forTag(const BodyTag &tag) {
+  b2Filter filter;
+  filter.categoryBits = category(tag.type);
+  filter.maskBits = mask(tag.type);
+  return filter;
+}
+
 /**
  * PhysicsDispatcher.
  */
@@ -101,6 +156,61 @@ Physics::Settings::Settings() :
     gravity(150),
     fixtureDensity(10) { }
 
+/**
+ * Timestep.
+ */
+
+Timestep::Timestep() :
+    Timestep(1.0f / 60.0f, 1, 4) { }
+
+Timestep::Timestep(const TimeDiff step,
+                   const unsigned int substeps,
+                   const unsigned int maxSteps) :
+    step(step),
+    substeps(substeps),
+    maxSteps(maxSteps) { }
+
+/**
+ * StepStats.
+ */
+
+StepStats::StepStats(const RollingSampler<unsigned int> &sampler,
+                     const size_t totalSteps, const size_t clampedTicks) :
+    min(sampler.min()),
+    max(sampler.max()),
+    mean(sampler.mean<float>()),
+    totalSteps(totalSteps),
+    clampedTicks(clampedTicks) { }
+
+std::string StepStats::print() const {
+  return std::to_string(mean) + ":"
+      + std::to_string(min) + "->" + std::to_string(max)
+      + " (" + std::to_string(totalSteps) + " steps, "
+      + std::to_string(clampedTicks) + " clamped)";
+}
+
+/**
+ * PoolStats.
+ */
+
+PoolStats::PoolStats() :
+    bodiesCreated(0),
+    bodiesRecycled(0),
+    tagChunks(0) { }
+
+PoolStats &PoolStats::operator+=(const PoolStats &stats) {
+  bodiesCreated += stats.bodiesCreated;
+  bodiesRecycled += stats.bodiesRecycled;
+  tagChunks += stats.tagChunks;
+  return *this;
+}
+
+std::string PoolStats::print() const {
+  return std::to_string(bodiesCreated) + " created, "
+      + std::to_string(bodiesRecycled) + " recycled, "
+      + std::to_string(tagChunks) + " tag chunks";
+}
+
 /**
  * Physics.
  */
@@ -116,7 +226,7 @@ void Physics::createFixture(const Shape &shape, b2Body &body) {
       break;
     }
     case Shape::Type::Polygon: {
-      polygonFixture(shape.vertices, body);
+      polygonFixture(shape.vertices, shape.triangles, body);
       break;
     }
     default:
@@ -130,7 +240,21 @@ void Physics::circleFixture(const float radius, b2Body &body) {
   body.CreateFixture(&shape, settings.fixtureDensity);
 }
 
-void Physics::polygonFixture(const std::vector<sf::Vector2f> &vertices, b2Body &body) {
+void Physics::polygonFixture(const std::vector<sf::Vector2f> &vertices,
+                             const std::vector<uint16_t> &triangles,
+                             b2Body &body) {
+  if (!triangles.empty()) {
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+      const b2Vec2 points[3] = {toPhysVec(vertices[triangles[i]]),
+                                toPhysVec(vertices[triangles[i + 1]]),
+                                toPhysVec(vertices[triangles[i + 2]])};
+      b2PolygonShape shape;
+      shape.Set(points, 3);
+      body.CreateFixture(&shape, settings.fixtureDensity);
+    }
+    return;
+  }
+
   // I love great APIs!
   std::vector<sf::Vector2f> verts(vertices);
   pp::Poly poly(verts);
@@ -164,6 +288,10 @@ void Physics::rectFixture(const sf::Vector2f &dimensions, b2Body &body) {
 Physics::Physics(const Map &map, PhysicsListener &listener) :
     world({0, Settings().gravity / Settings().distanceScale}),
     converter(listener),
+    accumulator(0),
+    stepSampler(60),
+    totalSteps(0),
+    clampedTicks(0),
     dims(map.getDimensions()) {
   // world boundaries
   b2Body *body;
@@ -181,8 +309,9 @@ Physics::Physics(const Map &map, PhysicsListener &listener) :
 
   // Create obstacles from map.
   for (const auto &obstacle : map.getObstacles()) {
-    body = createBody(Shape::Polygon(obstacle.localVertices),
-                      BodyTag::ObstacleTag(obstacle), false, true);
+    body = createBody(
+        Shape::Polygon(obstacle.localVertices, obstacle.triangles),
+        BodyTag::ObstacleTag(obstacle), false, true);
     body->SetTransform(toPhysVec(obstacle.pos), 0);
   }
 
@@ -193,17 +322,73 @@ Physics::Physics(const Map &map, PhysicsListener &listener) :
 }
 
 Physics::~Physics() {
-  for (b2Body *body = world.GetBodyList();
-       body != nullptr;
-       body = body->GetNext()) {
-    delete (BodyTag *) body->GetUserData();
+  // Tags are freed with the slab, bodies with the world.
+}
+
+b2Body *Physics::recycleBody(const Shape &shape) {
+  const auto pool = bodyPool.find(shape);
+  if (pool == bodyPool.end() or pool->second.empty()) return nullptr;
+
+  b2Body *body = pool->second.back();
+  pool->second.pop_back();
+  body->SetActive(true);
+  return body;
+}
+
+unsigned int Physics::beginTick(const TimeDiff delta) {
+  lastPoolStats = tickPoolStats;
+  totalPoolStats += tickPoolStats;
+  tickPoolStats = PoolStats();
+
+  accumulator += delta;
+
+  unsigned int steps = 0;
+  while (accumulator >= timestep.step) {
+    if (steps == timestep.maxSteps) {
+      // We can't keep up; drop the time rather than spiral.
+      accumulator = std::fmod(accumulator, timestep.step);
+      clampedTicks++;
+      break;
+    }
+    accumulator -= timestep.step;
+    steps++;
   }
+
+  stepSampler.push(steps);
+  return steps;
 }
 
-void Physics::tick(const TimeDiff delta) {
+void Physics::step() {
+  const TimeDiff substep = timestep.step / float(timestep.substeps);
+  for (unsigned int i = 0; i < timestep.substeps; ++i)
+    world.Step(substep,
+               settings.velocityIterations, settings.positionIterations);
   world.ClearForces();
-  world.Step(delta,
-             settings.velocityIterations, settings.positionIterations);
+  totalSteps++;
+}
+
+unsigned int Physics::tick(const TimeDiff delta) {
+  const unsigned int steps = beginTick(delta);
+  for (unsigned int i = 0; i < steps; ++i) step();
+  return steps;
+}
+
+void Physics::setTimestep(const Timestep &timestep) {
+  assert(timestep.step > 0 and timestep.substeps > 0);
+  this->timestep = timestep;
+  accumulator = std::fmod(accumulator, timestep.step);
+}
+
+const Timestep &Physics::getTimestep() const {
+  return timestep;
+}
+
+float Physics::getAlpha() const {
+  return clamp(0.0f, 1.0f, accumulator / timestep.step);
+}
+
+StepStats Physics::getStepStats() const {
+  return StepStats(stepSampler, totalSteps, clampedTicks);
 }
 
 sf::Vector2f Physics::toGameVec(const b2Vec2 &vec) const {
@@ -228,24 +413,79 @@ b2Body *Physics::createBody(const Shape &shape,
                             const BodyTag &tag,
                             bool isBullet,
                             bool isStatic) {
-  b2BodyDef def;
-  def.fixedRotation = false;
-  def.bullet = isBullet;
-  def.type = isStatic ? b2_staticBody : b2_dynamicBody;
-
-  b2Body *body = world.CreateBody(&def);
-  body->SetUserData(new BodyTag(tag));
-  createFixture(shape, *body);
+  b2Body *body = isStatic ? nullptr : recycleBody(shape);
+  if (body) {
+    tickPoolStats.bodiesRecycled++;
+    body->SetTransform({0, 0}, 0);
+    body->SetLinearVelocity({0, 0});
+    body->SetAngularVelocity(0);
+    body->SetGravityScale(1);
+    body->SetBullet(isBullet);
+    body->SetAwake(true);
+  } else {
+    tickPoolStats.bodiesCreated++;
+    b2BodyDef def;
+    def.fixedRotation = false;
+    def.bullet = isBullet;
+    def.type = isStatic ? b2_staticBody : b2_dynamicBody;
+
+    body = world.CreateBody(&def);
+    createFixture(shape, *body);
+    if (!isStatic) poolOf.emplace(body, &bodyPool[shape]);
+  }
+
+  const size_t chunks = tags.chunkCount();
+  body->SetUserData(tags.acquire(tag));
+  tickPoolStats.tagChunks += tags.chunkCount() - chunks;
+
+  const b2Filter filter = CollisionFilter::forTag(tag);
+  for (b2Fixture *fixture = body->GetFixtureList();
+       fixture != nullptr;
+       fixture = fixture->GetNext()) {
+    fixture->SetFilterData(filter);
+  }
+
   return body;
 }
 
 void Physics::deleteBody(b2Body *const body) {
   if (body) {
-    delete (BodyTag *) body->GetUserData();
-    world.DestroyBody(body);
+    // Contacts are ended here, so the tag must outlive this.
+    BodyTag *tag = (BodyTag *) body->GetUserData();
+    if (body->GetType() == b2_staticBody) {
+      world.DestroyBody(body);
+    } else {
+      body->SetActive(false);
+      body->SetUserData(nullptr);
+      poolOf.at(body)->push_back(body);
+    }
+    tags.release(tag);
   }
 }
 
+PoolStats Physics::getPoolStats(const bool total) const {
+  return total ? totalPoolStats : lastPoolStats;
+}
+
+optional<float> Physics::castStatic(const sf::Vector2f &from,
+                                    const sf::Vector2f &to) {
+  struct Callback: public b2RayCastCallback {
+    optional<float> nearest;
+
+    float32 ReportFixture(b2Fixture *fixture, const b2Vec2 &,
+                          const b2Vec2 &, float32 fraction) override {
+      if (fixture->GetBody()->GetType() != b2_staticBody) return -1;
+      nearest = fraction;
+      return fraction; // Clip the ray, we only want the closest.
+    }
+  } callback;
+
+  const b2Vec2 p1 = toPhysVec(from), p2 = toPhysVec(to);
+  if ((p2 - p1).LengthSquared() == 0) return {};
+  world.RayCast(&callback, p1, p2);
+  return callback.nearest;
+}
+
 void Physics::approachRotVel(b2Body *body, float rotvel) const {
   body->ApplyAngularImpulse(
       body->GetInertia() * (toRad(rotvel) - body->GetAngularVelocity()),
@@ -275,6 +515,17 @@ PhysicalState::PhysicalState(const sf::Vector2f &pos,
                              const float rotvel) :
     pos(pos), vel(vel), rot(rot), rotvel(rotvel) { }
 
+PhysicalState PhysicalState::interpolate(const PhysicalState &from,
+                                         const PhysicalState &to,
+                                         const float alpha) {
+  const Cyclic fromRot(0, 360, from.rot);
+  return PhysicalState(
+      from.pos + alpha * (to.pos - from.pos),
+      from.vel + alpha * (to.vel - from.vel),
+      Angle(from.rot + alpha * cyclicDistance(fromRot, to.rot)),
+      from.rotvel + alpha * (to.rotvel - from.rotvel));
+}
+
 void PhysicalState::hardWriteToBody(const Physics &physics,
                                     b2Body *const body) const {
   body->SetLinearVelocity(physics.toPhysVec(vel));
@@ -19,6 +19,10 @@
  * Physics manager; wraps box2d.
  */
 #pragma once
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
 #include <Box2D/Box2D.h>
 #include "util/types.hpp"
 #include "engine/environment/map.hpp"
@@ -59,6 +63,47 @@ struct BodyTag {
 
 };
 
+/**
+ * Slab of BodyTags, handed out to bodies and recycled when they are deleted.
+ * Storage grows by whole chunks and is never released before the slab is.
+ */
+class TagSlab {
+ private:
+  using Storage = std::aligned_storage<sizeof(BodyTag), alignof(BodyTag)>::type;
+  static constexpr size_t chunkSize = 64;
+
+  std::vector<std::unique_ptr<Storage[]>> chunks;
+  std::vector<Storage *> free;
+
+ public:
+  TagSlab() = default;
+  TagSlab(const TagSlab &) = delete;
+
+  BodyTag *acquire(const BodyTag &tag);
+  void release(BodyTag *const tag);
+
+  size_t chunkCount() const;
+
+};
+
+/**
+ * Declarative collision matrix, keyed by BodyTag::Type. It's turned
+ * into box2d filter data when bodies are created, so filtered pairs never
+ * generate contacts at all.
+ *
+ * This is constant over the lifetime of a body; rules that depend on volatile
+ * state belong in PhysicsListener::enableContact. That includes team rules:
+ * a box2d group is fixed when the body is made, and can't follow a player
+ * who changes team while their plane is alive.
+ */
+struct CollisionFilter {
+  static uint16 category(const BodyTag::Type type);
+  static uint16 mask(const BodyTag::Type type);
+
+  static b2Filter forTag(const BodyTag &tag);
+
+};
+
 /**
  * Interface to listen to physical events.
  */
@@ -72,6 +117,7 @@ class PhysicsListener {
   virtual void onEndContact(const BodyTag &body1, const BodyTag &body2) = 0;
 
   // Decide whether a contact should occur. This should be constant over sky::Role.
+  // Static rules are cheaper to express through CollisionFilter.
   virtual bool enableContact(const BodyTag &body1, const BodyTag &body2) = 0;
 
 };
@@ -93,6 +139,52 @@ class PhysicsDispatcher: public b2ContactListener {
 
 };
 
+/**
+ * Parameters of the fixed timestep that Physics simulates with, independent
+ * of the delta it is ticked with.
+ */
+struct Timestep {
+  Timestep();
+  Timestep(const TimeDiff step,
+           const unsigned int substeps,
+           const unsigned int maxSteps);
+
+  TimeDiff step; // duration of a fixed step
+  unsigned int substeps, // box2d steps each fixed step is split into
+      maxSteps; // most fixed steps we catch up with in one tick
+};
+
+/**
+ * Statistics on the number of fixed steps Physics takes per tick.
+ */
+struct StepStats {
+  StepStats() = default;
+  StepStats(const RollingSampler<unsigned int> &sampler,
+            const size_t totalSteps, const size_t clampedTicks);
+
+  unsigned int min, max;
+  float mean;
+  size_t totalSteps, // fixed steps ever taken
+      clampedTicks; // ticks where we gave up catching up
+  std::string print() const;
+
+};
+
+/**
+ * Counts of what Physics had to allocate, as opposed to recycle.
+ */
+struct PoolStats {
+  PoolStats();
+
+  size_t bodiesCreated, // box2d bodies created from scratch
+      bodiesRecycled, // bodies taken from the pool
+      tagChunks; // TagSlab chunks allocated
+
+  PoolStats &operator+=(const PoolStats &stats);
+  std::string print() const;
+
+};
+
 /**
  * A physical world.
  */
@@ -110,10 +202,24 @@ class Physics {
   b2World world;
   PhysicsDispatcher converter;
 
+  // Recycling bodies, keyed by shape.
+  TagSlab tags;
+  std::map<Shape, std::vector<b2Body *>> bodyPool;
+  std::unordered_map<const b2Body *, std::vector<b2Body *> *> poolOf;
+  PoolStats tickPoolStats, lastPoolStats, totalPoolStats;
+  b2Body *recycleBody(const Shape &shape);
+
+  // Fixed timestep.
+  Timestep timestep;
+  TimeDiff accumulator;
+  RollingSampler<unsigned int> stepSampler;
+  size_t totalSteps, clampedTicks;
+
   // Turing shapes into fixtures for use in the box2d engine.
   void createFixture(const Shape &shape, b2Body &body);
   void circleFixture(const float radius, b2Body &body);
-  void polygonFixture(const std::vector<sf::Vector2f> &vertices, b2Body &body);
+  void polygonFixture(const std::vector<sf::Vector2f> &vertices,
+                      const std::vector<uint16_t> &triangles, b2Body &body);
   void rectFixture(const sf::Vector2f &dimensions, b2Body &body);
 
  public:
@@ -124,7 +230,19 @@ class Physics {
 
   const sf::Vector2f dims;
 
-  void tick(const TimeDiff delta);
+  // Advance by as many fixed steps as fit into the accumulated time.
+  unsigned int tick(const TimeDiff delta);
+  // The same in two parts, for callers with work around each step:
+  // accumulate a tick's time, getting the number of fixed steps it
+  // completes, then take them one by one.
+  unsigned int beginTick(const TimeDiff delta);
+  void step();
+
+  // Fixed timestep.
+  void setTimestep(const Timestep &timestep);
+  const Timestep &getTimestep() const;
+  float getAlpha() const; // progress towards the next fixed step, in [0, 1)
+  StepStats getStepStats() const;
 
   // Unit conversion.
   sf::Vector2f toGameVec(const b2Vec2 &vec) const;
@@ -132,12 +250,18 @@ class Physics {
   float toGameDistance(const float x) const;
   float toPhysDistance(const float x) const;
 
-  // Managing bodies.
+  // Managing bodies. Deleted dynamic bodies are pooled and handed back
+  // out by createBody for the same shape.
   b2Body *createBody(const Shape &shape,
                      const BodyTag &tag,
                      bool isBullet = false,
                      bool isStatic = false);
   void deleteBody(b2Body *const body);
+  PoolStats getPoolStats(const bool total = false) const; // last tick or total
+
+  // Querying the world. Ray casts only see static bodies (obstacles and
+  // boundaries), and return the fraction along the ray of the first hit.
+  optional<float> castStatic(const sf::Vector2f &from, const sf::Vector2f &to);
 
   // Impulses.
   void approachRotVel(b2Body *body, float rotvel) const;
@@ -165,6 +289,11 @@ struct PhysicalState {
   Angle rot;
   float rotvel;
 
+  // Blend between two states, turning rotation the short way round.
+  static PhysicalState interpolate(const PhysicalState &from,
+                                   const PhysicalState &to,
+                                   const float alpha);
+
   void hardWriteToBody(const Physics &physics, b2Body *const body) const;
   void writeToBody(const Physics &physics, b2Body *const body) const;
   void readFromBody(const Physics &physics, const b2Body *const body);
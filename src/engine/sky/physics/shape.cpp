@@ -33,9 +33,11 @@ Shape sky::Shape::Circle(const float radius) {
   return shape;
 }
 
-Shape sky::Shape::Polygon(const std::vector<sf::Vector2f> &vertices) {
+Shape sky::Shape::Polygon(const std::vector<sf::Vector2f> &vertices,
+                          const std::vector<uint16_t> &triangles) {
   sky::Shape shape(Type::Polygon);
   shape.vertices = vertices;
+  shape.triangles = triangles;
   return shape;
 }
 
@@ -45,5 +47,25 @@ Shape sky::Shape::Rectangle(const sf::Vector2f &dimensions) {
   return shape;
 }
 
+bool operator<(const Shape &x, const Shape &y) {
+  if (x.type != y.type) return x.type < y.type;
+  switch (x.type) {
+    case Shape::Type::Circle:
+      return x.radius.get() < y.radius.get();
+    case Shape::Type::Rectangle: {
+      const sf::Vector2f &dx = x.dimensions.get(), &dy = y.dimensions.get();
+      return std::tie(dx.x, dx.y) < std::tie(dy.x, dy.y);
+    }
+    case Shape::Type::Polygon:
+      return std::lexicographical_compare(
+          x.vertices.begin(), x.vertices.end(),
+          y.vertices.begin(), y.vertices.end(),
+          [](const sf::Vector2f &a, const sf::Vector2f &b) {
+            return std::tie(a.x, a.y) < std::tie(b.x, b.y);
+          });
+    default:
+      throw enum_error();
+  }
 }
 
+}
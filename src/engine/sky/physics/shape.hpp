@@ -40,6 +40,9 @@ struct Shape {
 
   optional<float> radius; // Circle.
   std::vector<sf::Vector2f> vertices; // Polygon.
+  // Polygon: precomputed triangulation, as triples of indices into vertices.
+  // Triangulated when the fixture is made if this is empty.
+  std::vector<uint16_t> triangles;
   optional<sf::Vector2f> dimensions; // Rectangle.
 
  private:
@@ -50,7 +53,8 @@ struct Shape {
 
   // Helpful constructors.
   static Shape Circle(const float radius);
-  static Shape Polygon(const std::vector<sf::Vector2f> &vertices);
+  static Shape Polygon(const std::vector<sf::Vector2f> &vertices,
+                       const std::vector<uint16_t> &triangles = {});
   static Shape Rectangle(const sf::Vector2f &dimensions);
 
   // Cereal serialization.
@@ -75,5 +79,8 @@ struct Shape {
 
 };
 
+// Strict ordering over shape geometry, so shapes can key containers.
+bool operator<(const Shape &x, const Shape &y);
+
 }
 
@@ -0,0 +1,200 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <tuple>
+#include "projectiles.hpp"
+#include "util/methods.hpp"
+
+namespace sky {
+
+/**
+ * ProjectileSpawn.
+ */
+
+ProjectileSpawn::ProjectileSpawn(const PID owner,
+                                 const sf::Vector2f &pos,
+                                 const sf::Vector2f &vel,
+                                 const float lifetime,
+                                 const float damage) :
+    owner(owner),
+    pos(pos),
+    vel(vel),
+    lifetime(lifetime),
+    damage(damage) { }
+
+/**
+ * ProjectileTarget.
+ */
+
+ProjectileTarget::ProjectileTarget(const PID pid,
+                                   const sf::Vector2f &pos,
+                                   const float rot,
+                                   const sf::Vector2f &hitbox) :
+    pid(pid),
+    pos(pos),
+    cosRot(std::cos(toRad(rot))),
+    sinRot(std::sin(toRad(rot))),
+    halfExtents(hitbox / 2.0f),
+    radius(VecMath::length(halfExtents)) { }
+
+/**
+ * Projectiles.
+ */
+
+void Projectiles::remove(const size_t i) {
+  const size_t last = size() - 1;
+  owner[i] = owner[last];
+  posX[i] = posX[last];
+  posY[i] = posY[last];
+  velX[i] = velX[last];
+  velY[i] = velY[last];
+  lifetime[i] = lifetime[last];
+  damage[i] = damage[last];
+  toX[i] = toX[last];
+  toY[i] = toY[last];
+
+  owner.pop_back();
+  for (auto *field : {&posX, &posY, &velX, &velY, &lifetime, &damage,
+                      &toX, &toY}) {
+    field->pop_back();
+  }
+}
+
+void Projectiles::spawn(const ProjectileSpawn &spawn) {
+  owner.push_back(spawn.owner);
+  posX.push_back(spawn.pos.x);
+  posY.push_back(spawn.pos.y);
+  velX.push_back(spawn.vel.x);
+  velY.push_back(spawn.vel.y);
+  lifetime.push_back(spawn.lifetime);
+  damage.push_back(spawn.damage);
+}
+
+void Projectiles::clear() {
+  owner.clear();
+  for (auto *field : {&posX, &posY, &velX, &velY, &lifetime, &damage,
+                      &toX, &toY}) {
+    field->clear();
+  }
+}
+
+size_t Projectiles::size() const {
+  return owner.size();
+}
+
+void Projectiles::tick(const TimeDiff delta,
+                       Physics &physics,
+                       const std::vector<ProjectileTarget> &targets,
+                       std::vector<ProjectileHit> &hits) {
+  // Integrate all paths at once.
+  const size_t n = size();
+  toX.resize(n);
+  toY.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    toX[i] = posX[i] + velX[i] * delta;
+    toY[i] = posY[i] + velY[i] * delta;
+    lifetime[i] -= delta;
+  }
+
+  // Sweep each path; iterate backwards so removal doesn't skip anything.
+  for (size_t i = n; i-- > 0;) {
+    const sf::Vector2f from(posX[i], posY[i]), to(toX[i], toY[i]);
+    const sf::Vector2f lo(std::min(from.x, to.x), std::min(from.y, to.y)),
+        hi(std::max(from.x, to.x), std::max(from.y, to.y));
+
+    float nearest = 1;
+    bool hit = false;
+    optional<PID> target;
+
+    for (const auto &candidate : targets) {
+      if (candidate.pid == owner[i]) continue;
+      if (candidate.pos.x + candidate.radius < lo.x
+          or candidate.pos.x - candidate.radius > hi.x
+          or candidate.pos.y + candidate.radius < lo.y
+          or candidate.pos.y - candidate.radius > hi.y)
+        continue;
+
+      if (const auto fraction = sweepTarget(from, to, candidate)) {
+        if (*fraction <= nearest) {
+          nearest = *fraction;
+          target = candidate.pid;
+          hit = true;
+        }
+      }
+    }
+
+    if (const auto fraction = physics.castStatic(from, to)) {
+      if (*fraction < nearest) {
+        nearest = *fraction;
+        target.reset();
+        hit = true;
+      }
+    }
+
+    if (hit) {
+      hits.push_back({owner[i], target, from + (to - from) * nearest,
+                      damage[i]});
+      remove(i);
+    } else if (lifetime[i] <= 0) {
+      remove(i);
+    } else {
+      posX[i] = to.x;
+      posY[i] = to.y;
+    }
+  }
+}
+
+sf::Vector2f Projectiles::getPos(const size_t i) const {
+  return {posX[i], posY[i]};
+}
+
+sf::Vector2f Projectiles::getVel(const size_t i) const {
+  return {velX[i], velY[i]};
+}
+
+optional<float> Projectiles::sweepTarget(const sf::Vector2f &from,
+                                         const sf::Vector2f &to,
+                                         const ProjectileTarget &target) {
+  // Move into the target's frame, where its hitbox is axis-aligned.
+  const auto local = [&target](const sf::Vector2f &x) {
+    const sf::Vector2f d = x - target.pos;
+    return sf::Vector2f(d.x * target.cosRot + d.y * target.sinRot,
+                        -d.x * target.sinRot + d.y * target.cosRot);
+  };
+  const sf::Vector2f p = local(from), dir = local(to) - p;
+
+  // Slab test.
+  float enter = 0, exit = 1;
+  for (const auto &axis : {std::make_tuple(p.x, dir.x, target.halfExtents.x),
+                           std::make_tuple(p.y, dir.y, target.halfExtents.y)}) {
+    const float origin = std::get<0>(axis), extent = std::get<2>(axis),
+        step = std::get<1>(axis);
+    if (step == 0) {
+      if (origin < -extent or origin > extent) return {};
+      continue;
+    }
+    float t0 = (-extent - origin) / step, t1 = (extent - origin) / step;
+    if (t0 > t1) std::swap(t0, t1);
+    enter = std::max(enter, t0);
+    exit = std::min(exit, t1);
+    if (enter > exit) return {};
+  }
+
+  return enter;
+}
+
+}
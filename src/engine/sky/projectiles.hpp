@@ -0,0 +1,116 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Lightweight projectiles, simulated outside of box2d.
+ */
+#pragma once
+#include "util/types.hpp"
+#include "physics/physics.hpp"
+
+namespace sky {
+
+/**
+ * Everything that defines a projectile. This is all that is networked about
+ * it: clients simulate projectiles themselves from their spawn events.
+ */
+struct ProjectileSpawn {
+  ProjectileSpawn() = default; // packing
+  ProjectileSpawn(const PID owner,
+                  const sf::Vector2f &pos,
+                  const sf::Vector2f &vel,
+                  const float lifetime,
+                  const float damage);
+
+  template<typename Archive>
+  void serialize(Archive &ar) {
+    ar(owner, pos, vel, lifetime, damage);
+  }
+
+  PID owner; // PID of the shooting player
+  sf::Vector2f pos, vel;
+  float lifetime, // seconds before it expires
+      damage; // health removed from a plane it hits
+};
+
+/**
+ * A plane that projectiles can hit, as seen by Projectiles.
+ */
+struct ProjectileTarget {
+  ProjectileTarget(const PID pid,
+                   const sf::Vector2f &pos,
+                   const float rot,
+                   const sf::Vector2f &hitbox);
+
+  PID pid;
+  sf::Vector2f pos;
+  float cosRot, sinRot;
+  sf::Vector2f halfExtents;
+  float radius; // bounding circle, for quick rejection
+};
+
+/**
+ * A projectile ending on something.
+ */
+struct ProjectileHit {
+  PID owner;
+  optional<PID> target; // the plane we hit, if we didn't hit an obstacle
+  sf::Vector2f pos;
+  float damage;
+};
+
+/**
+ * All the projectiles in a Sky, packed into flat arrays. Each tick they are
+ * advanced together, and their paths are swept against the static geometry
+ * in Physics and against the planes' hitboxes.
+ */
+class Projectiles {
+ private:
+  std::vector<PID> owner;
+  std::vector<float> posX, posY, velX, velY, lifetime, damage;
+
+  // Scratch.
+  std::vector<float> toX, toY;
+
+  void remove(const size_t i);
+
+ public:
+  Projectiles() = default;
+
+  void spawn(const ProjectileSpawn &spawn);
+  void clear();
+  size_t size() const;
+
+  // Advance all projectiles, appending what they hit to `hits`.
+  void tick(const TimeDiff delta,
+            Physics &physics,
+            const std::vector<ProjectileTarget> &targets,
+            std::vector<ProjectileHit> &hits);
+
+  // Reading state.
+  sf::Vector2f getPos(const size_t i) const;
+  sf::Vector2f getVel(const size_t i) const;
+
+  // Segment from `from` to `to` against a target's hitbox, as the fraction
+  // along the segment of the entry point.
+  static optional<float> sweepTarget(const sf::Vector2f &from,
+                                     const sf::Vector2f &to,
+                                     const ProjectileTarget &target);
+
+};
+
+}
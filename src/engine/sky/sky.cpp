@@ -42,6 +42,7 @@ bool SkyDelta::verifyStructure() const {
 SkyDelta SkyDelta::respectAuthority(const Player &player) const {
   SkyDelta newDelta;
   newDelta.settings = settings;
+  newDelta.projectiles = projectiles;
 
   for (auto pDelta : participations) {
     if (pDelta.first == player.pid) {
@@ -87,6 +88,14 @@ void Sky::onTick(const TimeDiff delta) {
     zones.applyDestruction();
   }
 
+  // Everything simulates on the fixed timestep, so ticks of any length
+  // come out the same; a tick can take no steps, or several.
+  projectileHits.clear();
+  const unsigned int steps = physics.beginTick(delta);
+  for (unsigned int i = 0; i < steps; ++i) tickStep(physics.getTimestep().step);
+}
+
+void Sky::tickStep(const TimeDiff step) {
   // Synchronize state with box2d.
   for (auto &participation: participations) participation.second.prePhysics();
   entities.forData([](Entity &e, const PID) { e.prePhysics(); });
@@ -94,14 +103,63 @@ void Sky::onTick(const TimeDiff delta) {
   homeBases.forData([](HomeBase &e, const PID) { e.prePhysics(); });
   zones.forData([](Zone &e, const PID) { e.prePhysics(); });
 
-  physics.tick(delta);
+  physics.step();
 
   // Tick everything.
-  for (auto &participation: participations) participation.second.postPhysics(delta);
-  entities.forData([delta](Entity &e, const PID) { e.postPhysics(delta); });
-  explosions.forData([delta](Explosion &e, const PID) { e.postPhysics(delta); });
-  homeBases.forData([delta](HomeBase &e, const PID) { e.postPhysics(delta); });
-  zones.forData([delta](Zone &e, const PID) { e.postPhysics(delta); });
+  if (batchedFlight) tickPlanesBatched(step);
+  else for (auto &participation: participations)
+      participation.second.postPhysics(step);
+  entities.forData([step](Entity &e, const PID) { e.postPhysics(step); });
+  explosions.forData([step](Explosion &e, const PID) { e.postPhysics(step); });
+  homeBases.forData([step](HomeBase &e, const PID) { e.postPhysics(step); });
+  zones.forData([step](Zone &e, const PID) { e.postPhysics(step); });
+
+  tickProjectiles(step);
+}
+
+void Sky::tickProjectiles(const TimeDiff delta) {
+  projectileTargets.clear();
+  for (const auto &participation : participations) {
+    if (const auto &plane = participation.second.plane) {
+      projectileTargets.emplace_back(
+          participation.first, plane->state.physical.pos,
+          plane->state.physical.rot, plane->tuning.hitbox);
+    }
+  }
+
+  const size_t firstHit = projectileHits.size(); // earlier steps' are applied
+  projectiles.tick(delta, physics, projectileTargets, projectileHits);
+
+  // Clients only see hits through the resulting plane state.
+  if (!role.server()) return;
+  for (size_t i = firstHit; i < projectileHits.size(); ++i) {
+    const auto &hit = projectileHits[i];
+    if (!hit.target) continue;
+    const auto participation = participations.find(*hit.target);
+    if (participation == participations.end()) continue;
+    if (auto &plane = participation->second.plane)
+      plane->state.health -= hit.damage;
+  }
+}
+
+void Sky::tickPlanesBatched(const TimeDiff delta) {
+  flightBatch.clear();
+  for (auto &participation: participations) {
+    if (auto &plane = participation.second.plane) {
+      plane->readFromBody();
+      flightBatch.push(plane->state, plane->tuning, plane->controls);
+    }
+  }
+
+  flightBatch.tick(delta);
+
+  size_t index = 0;
+  for (auto &participation: participations) {
+    if (auto &plane = participation.second.plane) {
+      flightBatch.pull(index++, plane->state);
+      plane->tickWeapons(delta);
+    }
+  }
 }
 
 void Sky::onBeginContact(const BodyTag &body1, const BodyTag &body2) {
@@ -129,8 +187,7 @@ void Sky::onEndContact(const BodyTag &body1, const BodyTag &body2) {
 }
 
 bool Sky::enableContact(const BodyTag &body1, const BodyTag &body2) {
-  return !(body1.type == BodyTag::Type::Plane &&
-      body2.type == BodyTag::Type::Plane);
+  // Plane-plane contacts are filtered out by CollisionFilter before this is reached.
 //  for (auto s : arena.subsystems) {
 //    if (s.second != this)
 //      if (!s.second->enableContact(body1, body2))
@@ -159,6 +216,7 @@ Sky::Sky(Arena &arena, const Map &map, const SkyInit &initializer, SkyListener *
     zones(initializer.zones, physics),
 
     listener(listener),
+    batchedFlight(false),
     settings(initializer.settings) {
   arena.forPlayers([&](Player &player) {
     const auto iter = initializer.participations.find(player.pid);
@@ -193,6 +251,8 @@ void Sky::applyDelta(const SkyDelta &delta) {
   if (delta.homeBases) homeBases.applyDelta(delta.homeBases.get());
   if (delta.zones) zones.applyDelta(delta.zones.get());
 
+  for (const auto &spawn : delta.projectiles) projectiles.spawn(spawn);
+
 }
 
 SkyInit Sky::captureInitializer() const {
@@ -232,8 +292,10 @@ optional<SkyDelta> Sky::collectDelta() {
   delta.explosions = explosions.collectDelta();
   delta.homeBases = homeBases.collectDelta();
   delta.zones = zones.collectDelta();
+  delta.projectiles = std::move(newProjectiles);
+  newProjectiles.clear();
   useful |= delta.settings or delta.entities or delta.explosions
-      or delta.homeBases or delta.zones;
+      or delta.homeBases or delta.zones or !delta.projectiles.empty();
 
   if (useful) return delta;
   return {};
@@ -243,6 +305,10 @@ const Map &Sky::getMap() const {
   return map;
 }
 
+const Physics &Sky::getPhysics() const {
+  return physics;
+}
+
 Participation &Sky::getParticipation(const Player &player) const {
   return getPlayerData(player);
 }
@@ -253,6 +319,14 @@ void Sky::changeSettings(const SkySettingsDelta &delta) {
   syncSettings();
 }
 
+void Sky::setBatchedFlight(const bool enabled) {
+  batchedFlight = enabled;
+}
+
+bool Sky::usesBatchedFlight() const {
+  return batchedFlight;
+}
+
 Components<Entity> Sky::getEntities() {
   return entities.getData();
 }
@@ -269,6 +343,14 @@ Components<Zone> Sky::getZones() {
   return zones.getData();
 }
 
+const Projectiles &Sky::getProjectiles() const {
+  return projectiles;
+}
+
+const std::vector<ProjectileHit> &Sky::getProjectileHits() const {
+  return projectileHits;
+}
+
 void Sky::spawnEntity(const EntityState &state) {
   assert(role.server());
   entities.put(state);
@@ -279,4 +361,10 @@ void Sky::spawnExplosion(const ExplosionState &state) {
   explosions.put(state);
 }
 
+void Sky::spawnProjectile(const ProjectileSpawn &spawn) {
+  assert(role.server());
+  projectiles.spawn(spawn);
+  newProjectiles.push_back(spawn);
+}
+
 }
@@ -21,6 +21,8 @@
 #pragma once
 #include "engine/sky/physics/physics.hpp"
 #include "participation.hpp"
+#include "flightbatch.hpp"
+#include "projectiles.hpp"
 #include "skysettings.hpp"
 #include "engine/arena.hpp"
 #include "skylistener.hpp"
@@ -55,13 +57,15 @@ struct SkyDelta: public VerifyStructure {
 
   template<typename Archive>
   void serialize(Archive &ar) {
-    ar(settings, participations, entities, explosions);
+    ar(settings, participations, entities, explosions, projectiles);
   }
 
   bool verifyStructure() const;
 
   optional<SkySettingsDelta> settings;
 
+  std::vector<ProjectileSpawn> projectiles; // spawned since the last delta
+
   std::map<PID, ParticipationDelta> participations;
 
   COMPONENT_DELTAS
@@ -92,6 +96,16 @@ class Sky: public PhysicsListener,
   // GameHandler.
   SkyListener *listener;
 
+  // Batched flight model, when enabled.
+  bool batchedFlight;
+  FlightBatch flightBatch;
+
+  // Projectiles.
+  Projectiles projectiles;
+  std::vector<ProjectileSpawn> newProjectiles;
+  std::vector<ProjectileTarget> projectileTargets;
+  std::vector<ProjectileHit> projectileHits;
+
  protected:
   void registerPlayerWith(Player &player,
                           const ParticipationInit &initializer);
@@ -115,6 +129,15 @@ class Sky: public PhysicsListener,
   // Loading components from map at game start (server-side only).
   void spawnMapComponents();
 
+  // One fixed step of everything, from box2d sync to projectiles.
+  void tickStep(const TimeDiff step);
+
+  // Ticking planes through the FlightBatch.
+  void tickPlanesBatched(const TimeDiff delta);
+
+  // Ticking projectiles, and applying their hits (server-side only).
+  void tickProjectiles(const TimeDiff delta);
+
  public:
   Sky(Arena &arena, Map &&map,
       const SkyInit &, SkyListener *) = delete; // Map can't be temp
@@ -133,17 +156,25 @@ class Sky: public PhysicsListener,
 
   // User API: reading state.
   const Map &getMap() const;
+  const Physics &getPhysics() const;
   Participation &getParticipation(const Player &player) const;
   void changeSettings(const SkySettingsDelta &delta);
 
+  // Tick the flight model of all planes at once (off by default).
+  void setBatchedFlight(const bool enabled);
+  bool usesBatchedFlight() const;
+
   Components<Entity> getEntities();
   Components<Explosion> getExplosions();
   Components<HomeBase> getHomesBases();
   Components<Zone> getZones();
+  const Projectiles &getProjectiles() const;
+  const std::vector<ProjectileHit> &getProjectileHits() const; // last tick's
 
   // User API: server-side.
   void spawnEntity(const EntityState &state); // Spawn some entity
   void spawnExplosion(const ExplosionState &state);
+  void spawnProjectile(const ProjectileSpawn &spawn);
 
 };
 
@@ -15,6 +15,7 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include "skyhandle.hpp"
 #include "util/printer.hpp"
 
@@ -24,17 +25,81 @@ namespace sky {
  * SkyHandle.
  */
 
+void SkyHandle::prefetchNextEnv() {
+  prefetchDeferred = false;
+  const auto &url = arena.getNextEnv();
+  if (prefetched and prefetched->url == url) return;
+
+  if (prefetched) {
+    prefetched->cancel();
+    abandoned.push_back(std::move(prefetched));
+  }
+  if (environment and environment->url == url) return;
+
+  // Bound the loads in flight without waiting on them: if too many are still
+  // finishing, try again on a later tick.
+  reapAbandoned();
+  if (abandoned.size() > maxAbandoned) {
+    prefetchDeferred = true;
+    return;
+  }
+
+  appLog("Prefetching environment " + inQuotes(url) + ".", LogOrigin::Engine);
+  prefetched = std::make_unique<Environment>(url);
+}
+
+void SkyHandle::reapAbandoned() {
+  // Only idle loads are destroyed, so this never waits on the pool.
+  abandoned.erase(
+      std::remove_if(abandoned.begin(), abandoned.end(),
+                     [](const std::unique_ptr<Environment> &env) {
+                       return env->loadingIdle();
+                     }),
+      abandoned.end());
+}
+
+std::unique_ptr<Environment> SkyHandle::takeEnvironment(
+    const EnvironmentURL &url) {
+  if (prefetched and prefetched->url == url) {
+    appLog("Using prefetched environment " + inQuotes(url) + ".",
+           LogOrigin::Engine);
+    return std::move(prefetched);
+  }
+  return std::make_unique<Environment>(url);
+}
+
+void SkyHandle::onTick(const TimeDiff) {
+  if (!abandoned.empty()) reapAbandoned();
+  if (prefetchDeferred) prefetchNextEnv();
+}
+
+void SkyHandle::onMapChange() {
+  prefetchNextEnv();
+}
+
 SkyHandle::SkyHandle(Arena &arena, const SkyHandleInit &initializer) :
     Subsystem(arena),
     Networked(initializer),
     environment(),
     sky(),
-    envStateIsNew(false) {
-  if (initializer) environment.emplace(initializer.get());
+    envStateIsNew(false),
+    prefetchDeferred(false) {
+  if (initializer) environment = takeEnvironment(initializer.get());
+  prefetchNextEnv();
+}
+
+SkyHandle::~SkyHandle() {
+  sky.reset();
+  if (prefetched) prefetched->cancel();
+  for (auto &env : abandoned) env->cancel();
 }
 
 Environment *SkyHandle::getEnvironment() {
-  return environment.get_ptr();
+  return environment.get();
+}
+
+Environment const *SkyHandle::getPrefetched() const {
+  return prefetched.get();
 }
 
 Sky *SkyHandle::getSky() {
@@ -42,7 +107,7 @@ Sky *SkyHandle::getSky() {
 }
 
 Environment const *SkyHandle::getEnvironment() const {
-  return environment.get_ptr();
+  return environment.get();
 }
 
 Sky const *SkyHandle::getSky() const {
@@ -69,7 +134,8 @@ optional<SkyHandleDelta> SkyHandle::collectDelta() {
 
 void SkyHandle::applyDelta(const SkyHandleDelta &delta) {
   if (delta) {
-    environment.emplace(delta.get());
+    sky.reset();
+    environment = takeEnvironment(delta.get());
     caller.doStartGame();
   } else {
     sky.reset();
@@ -80,7 +146,8 @@ void SkyHandle::applyDelta(const SkyHandleDelta &delta) {
 
 void SkyHandle::start() {
   envStateIsNew = true;
-  environment.emplace(arena.getNextEnv());
+  sky.reset();
+  environment = takeEnvironment(arena.getNextEnv());
   caller.doStartGame();
 }
 
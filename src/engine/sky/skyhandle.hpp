@@ -31,23 +31,48 @@ using SkyHandleDelta = optional<EnvironmentURL>;
 /**
  * Wraps an optional<Sky>, binding it to the arena when the game is in session.
  * Also wraps its Networked implementation.
+ *
+ * The arena's next environment is loaded in the background as soon as it's
+ * chosen, and swapped in when the game starts. If the choice changes first,
+ * the prefetch is cancelled and left to finish on its own. While a few of
+ * those are still finishing, the next prefetch waits for a later tick
+ * rather than for them.
  */
 class SkyHandle
     : public Subsystem<Nothing>,
       public Networked<SkyHandleInit, SkyHandleDelta> {
  private:
   // Wrapped state: environment and sky.
-  optional<Environment> environment;
+  std::unique_ptr<Environment> environment;
   optional<Sky> sky;
 
   // Delta collection state.
   bool envStateIsNew;
 
+  // Prefetching.
+  std::unique_ptr<Environment> prefetched;
+  std::vector<std::unique_ptr<Environment>> abandoned;
+  bool prefetchDeferred; // retried on tick
+  void prefetchNextEnv();
+  void reapAbandoned();
+  // The prefetched environment if it's for this URL, or a new one.
+  std::unique_ptr<Environment> takeEnvironment(const EnvironmentURL &url);
+
+ protected:
+  // Subsystem impl.
+  void onTick(const TimeDiff delta) override;
+  void onMapChange() override;
+
  public:
   SkyHandle(class Arena &parent, const SkyHandleInit &initializer);
+  ~SkyHandle();
+
+  // Cancelled prefetches still finishing, past which we defer the next one.
+  static constexpr size_t maxAbandoned = 2;
 
   // Accessing.
   Environment *getEnvironment();
+  Environment const *getPrefetched() const;
   Sky *getSky();
   Environment const *getEnvironment() const;
   Sky const *getSky() const;
@@ -0,0 +1,58 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Compiles a map.json into the .skymap format.
+ */
+#include <fstream>
+#include "engine/environment/map.hpp"
+#include "util/printer.hpp"
+
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    appLog("Usage: solemnsky_mapcompiler <map.json> <map.skymap>",
+           LogOrigin::Error);
+    return 1;
+  }
+
+  std::ifstream input(argv[1]);
+  if (!input) {
+    appLog("Could not open " + std::string(argv[1]), LogOrigin::Error);
+    return 1;
+  }
+
+  const auto map = sky::Map::load(input);
+  if (!map) return 1;
+
+  const std::string compiled = map->saveCompiled();
+  if (!sky::Map::loadCompiled(compiled.data(), compiled.size())) {
+    appLog("Compiled map does not read back!", LogOrigin::Error);
+    return 1;
+  }
+
+  std::ofstream output(argv[2], std::ios::binary);
+  output.write(compiled.data(), compiled.size());
+  if (!output) {
+    appLog("Could not write " + std::string(argv[2]), LogOrigin::Error);
+    return 1;
+  }
+
+  appLog("Compiled " + std::to_string(map->getObstacles().size())
+             + " obstacles into " + std::to_string(compiled.size())
+             + " bytes.", LogOrigin::App);
+  return 0;
+}
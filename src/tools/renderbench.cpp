@@ -0,0 +1,345 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Offscreen benchmark of SkyRender: renders a populated Sky into an
+ * sf::RenderTexture for a fixed number of frames, and reports frame times,
+ * draw calls and vertex counts.
+ *
+ * The scene is synthetic and deterministic: planes flying on a grid over the
+ * environment's map, entities between them, and a steady stream of
+ * projectiles. Rendering needs a GL context; on headless machines run it
+ * under a virtual X server with software GL, for instance
+ * `LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a solemnsky_renderbench demo`.
+ *
+ * It exits non-zero when a frame draws nothing, or when a limit given with
+ * --max-p95-ms=<ms> or --max-draw-calls=<n> is exceeded, so CI can gate on it.
+ */
+#include <SFML/OpenGL.hpp>
+#include "client/client.hpp"
+#include "client/engine/skyrender.hpp"
+#include "engine/environment/environment.hpp"
+#include "util/printer.hpp"
+
+/**
+ * One frame's measurements.
+ */
+struct BenchFrame {
+  TimeDiff recordTime, replayTime;
+  size_t drawCalls, vertices, prims;
+};
+
+/**
+ * A Sky and a SkyRender, with everything a SkyRender expects from the
+ * client around them.
+ */
+class RenderBench {
+ private:
+  // AppRefs, as ControlExec would hold them.
+  ui::Settings settings;
+  Time uptime;
+  float tickAlpha;
+  ui::Profiler profiler;
+  ui::AppRefs references;
+  Client client;
+  ClientShared shared;
+
+  // The scene.
+  sky::Arena arena;
+  sky::Sky sky;
+  sky::SkyRender skyRender;
+  size_t ticks;
+  optional<PID> followed; // the first plane, which the camera follows
+
+  // Rendering.
+  sf::RenderTexture &texture;
+  ui::Frame frame;
+  ui::DrawList drawList;
+
+  static TimeDiff secondsSince(
+      const std::chrono::steady_clock::time_point &start);
+  void fireProjectiles();
+
+ public:
+  RenderBench(sf::RenderTexture &texture,
+              const ui::AppResources &resources,
+              const sky::Map &map);
+
+  static constexpr TimeDiff tickStep = 1.0f / 60.0f;
+
+  void populate(const size_t planes);
+  void tick();
+  BenchFrame renderFrame();
+  void printDebug(Printer &p) const;
+
+};
+
+RenderBench::RenderBench(sf::RenderTexture &texture,
+                         const ui::AppResources &resources,
+                         const sky::Map &map) :
+    settings("solemnsky-renderbench-settings.json"),
+    uptime(0),
+    tickAlpha(0.5), // between ticks, so interpolation is exercised
+    profiler(1),
+    references(settings, resources, uptime, tickAlpha, tickStep,
+               texture, profiler),
+    client(references),
+    shared(client, references),
+    arena(sky::ArenaInit("render bench", "NULL", sky::ArenaMode::Game),
+          {}, true),
+    sky(arena, map, sky::SkyInit()),
+    skyRender(shared, resources, arena, sky),
+    ticks(0),
+    followed(),
+    texture(texture),
+    frame(texture) { }
+
+TimeDiff RenderBench::secondsSince(
+    const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<TimeDiff>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+void RenderBench::fireProjectiles() {
+  arena.forPlayers([&](const sky::Player &player) {
+    if (const auto &plane = sky.getParticipation(player).plane) {
+      const auto &physical = plane->getState().physical;
+      const sf::Vector2f dir = VecMath::fromAngle(physical.rot);
+      sky.spawnProjectile(sky::ProjectileSpawn(
+          player.pid, physical.pos + 40.0f * dir,
+          physical.vel + 800.0f * dir, 1, 0));
+    }
+  });
+}
+
+void RenderBench::populate(const size_t planes) {
+  const auto &dims = sky.getMap().getDimensions();
+  const size_t columns = size_t(std::ceil(std::sqrt(float(planes) * 16 / 9)));
+  const size_t rows = (planes + columns - 1) / columns;
+  const sf::Vector2f spacing(dims.x / (columns + 1), dims.y / (rows + 1));
+
+  sky::PlaneControls controls;
+  controls.doAction(sky::Action::Thrust, true);
+  sky::ParticipationInput input;
+  input.controls = controls;
+
+  for (size_t i = 0; i < planes; ++i) {
+    const sf::Vector2f pos(spacing.x * (i % columns + 1),
+                           spacing.y * (i / columns + 1));
+    const sky::ArenaDelta delta = arena.connectPlayer("bench plane");
+    auto &participation =
+        sky.getParticipation(*arena.getPlayer(delta.join->pid));
+    if (!followed) followed = delta.join->pid;
+    participation.spawn({}, pos, float((i * 37) % 360));
+    participation.applyInput(input);
+
+    if (i % 4 == 0) {
+      sky.spawnEntity(sky::EntityState(
+          {}, {}, sky::Shape::Circle(10),
+          pos + spacing / 2.0f, sf::Vector2f(0, 0)));
+    }
+  }
+}
+
+void RenderBench::tick() {
+  if (ticks++ % 10 == 0) fireProjectiles();
+  uptime += Time(tickStep);
+  arena.tick(tickStep);
+}
+
+BenchFrame RenderBench::renderFrame() {
+  BenchFrame result;
+
+  // Follow the first plane, like a player would.
+  sf::Vector2f focus = sky.getMap().getDimensions() / 2.0f;
+  if (const auto player = followed ? arena.getPlayer(*followed) : nullptr) {
+    if (const auto &plane = sky.getParticipation(*player).plane)
+      focus = plane->getState().physical.pos;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  frame.beginDraw(drawList);
+  skyRender.render(frame, focus);
+  frame.endDraw();
+  result.recordTime = secondsSince(start);
+
+  // Wait for the GL to finish, so we time the rendering and not just its
+  // submission.
+  start = std::chrono::steady_clock::now();
+  drawList.replay(texture);
+  texture.display();
+  glFinish();
+  result.replayTime = secondsSince(start);
+
+  result.drawCalls = drawList.drawCalls();
+  result.vertices = drawList.vertexCount();
+  result.prims = frame.primCount;
+  return result;
+}
+
+void RenderBench::printDebug(Printer &p) const {
+  skyRender.printDebug(p);
+  p.printLn("projectiles: " + std::to_string(sky.getProjectiles().size()));
+}
+
+/**
+ * Loading.
+ */
+
+optional<sky::Map> loadMap(const std::string &url) {
+  sky::Environment environment(url);
+  environment.joinWorker();
+  if (environment.loadingErrored() or !environment.getMap()) return {};
+  return *environment.getMap();
+}
+
+bool loadResources(ui::ResourceLoader &loader) {
+  // Everything resident before timing starts.
+  loader.loadAllBlocking();
+  return loader.getHolder() and !loader.getErrorStatus();
+}
+
+/**
+ * Limits the run has to stay within.
+ */
+struct BenchLimits {
+  optional<TimeDiff> maxP95; // frame time, in seconds
+  optional<size_t> maxDrawCalls;
+
+  // Parses an option, or returns false if it isn't one of ours.
+  bool parse(const std::string &arg);
+  bool check(const TimeStats &frameTimes,
+             const RollingSampler<size_t> &drawCalls) const;
+};
+
+bool BenchLimits::parse(const std::string &arg) {
+  const auto value = [&](const std::string &name) -> optional<std::string> {
+    if (arg.compare(0, name.size(), name) == 0) return arg.substr(name.size());
+    return {};
+  };
+  if (const auto ms = value("--max-p95-ms=")) {
+    maxP95 = std::stof(*ms) / 1000.0f;
+    return true;
+  }
+  if (const auto count = value("--max-draw-calls=")) {
+    maxDrawCalls = std::stoul(*count);
+    return true;
+  }
+  return false;
+}
+
+bool BenchLimits::check(const TimeStats &frameTimes,
+                        const RollingSampler<size_t> &drawCalls) const {
+  bool passed = true;
+  if (drawCalls.min() == 0) {
+    appLog("No frame drew anything!", LogOrigin::Error);
+    passed = false;
+  }
+  if (maxP95 and frameTimes.p95 > *maxP95) {
+    appLog("Frame time p95 is over the limit of "
+               + std::to_string(int(std::round(*maxP95 * 1000))) + "ms!",
+           LogOrigin::Error);
+    passed = false;
+  }
+  if (maxDrawCalls and drawCalls.max() > *maxDrawCalls) {
+    appLog("Draw calls are over the limit of "
+               + std::to_string(*maxDrawCalls) + "!", LogOrigin::Error);
+    passed = false;
+  }
+  return passed;
+}
+
+int main(int argc, char **argv) {
+  BenchLimits limits;
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; ++i) {
+    if (!limits.parse(argv[i])) args.push_back(argv[i]);
+  }
+  if (args.size() > 4) {
+    appLog("Usage: solemnsky_renderbench [environment] [planes] [frames] "
+               "[screenshot.png] [--max-p95-ms=<ms>] [--max-draw-calls=<n>]",
+           LogOrigin::Error);
+    return 1;
+  }
+  const std::string url = args.size() > 0 ? args[0] : "demo";
+  const size_t planes = args.size() > 1 ? std::stoul(args[1]) : 64,
+      frames = args.size() > 2 ? std::stoul(args[2]) : 600;
+
+  sf::RenderTexture texture;
+  if (!texture.create(1600, 900)) {
+    appLog("Could not create a render texture; is there a GL context?",
+           LogOrigin::Error);
+    return 1;
+  }
+
+  const auto map = loadMap(url);
+  if (!map) {
+    appLog("Could not load environment " + inQuotes(url), LogOrigin::Error);
+    return 1;
+  }
+
+  ui::ResourceLoader loader({});
+  if (!loadResources(loader)) {
+    appLog("Could not load resources.", LogOrigin::Error);
+    return 1;
+  }
+
+  appLog("GL renderer: " + std::string((const char *) glGetString(GL_RENDERER)),
+         LogOrigin::App);
+
+  RenderBench bench(texture, *loader.getHolder(), map.get());
+  bench.populate(planes);
+  for (size_t i = 0; i < 60; ++i) bench.tick(); // Warm up.
+
+  RollingSampler<TimeDiff> recordTimes(frames), replayTimes(frames),
+      frameTimes(frames);
+  RollingSampler<size_t> drawCalls(frames), vertices(frames), prims(frames);
+  for (size_t i = 0; i < frames; ++i) {
+    bench.tick();
+    const BenchFrame result = bench.renderFrame();
+    recordTimes.push(result.recordTime);
+    replayTimes.push(result.replayTime);
+    frameTimes.push(result.recordTime + result.replayTime);
+    drawCalls.push(result.drawCalls);
+    vertices.push(result.vertices);
+    prims.push(result.prims);
+  }
+
+  StringPrinter p;
+  p.printLn(std::to_string(frames) + " frames of " + inQuotes(url) + " with "
+                + std::to_string(planes) + " planes:");
+  p.printLn("frame (min/mean/max): " + TimeStats(frameTimes).print());
+  p.printLn("frame (p50/p95/p99): " + TimeStats(frameTimes).printPercentiles());
+  p.printLn("record (p50/p95/p99): " + TimeStats(recordTimes).printPercentiles());
+  p.printLn("replay (p50/p95/p99): " + TimeStats(replayTimes).printPercentiles());
+  p.printLn("draw calls (mean/max): " + printFloat(drawCalls.mean<float>())
+                + "/" + std::to_string(drawCalls.max()));
+  p.printLn("vertices (mean/max): " + printFloat(vertices.mean<float>())
+                + "/" + std::to_string(vertices.max()));
+  p.printLn("prims (mean): " + printFloat(prims.mean<float>()));
+  bench.printDebug(p);
+  appLog(p.getString(), LogOrigin::App);
+
+  if (args.size() > 3) {
+    if (!texture.getTexture().copyToImage().saveToFile(args[3])) {
+      appLog("Could not write " + args[3], LogOrigin::Error);
+      return 1;
+    }
+  }
+
+  return limits.check(TimeStats(frameTimes), drawCalls) ? 0 : 1;
+}
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <cmath>
+#include <fstream>
 #include "splash.hpp"
 #include "util/printer.hpp"
 #include "util/clientutil.hpp"
@@ -26,13 +27,73 @@ namespace ui {
  * Profiler.
  */
 
-Profiler::Profiler(const unsigned int size) :
+Profiler::Profiler(const unsigned int size, const size_t historySize) :
+    lastAllocations(allocationCount()),
     cycleTime(size), logicTime(size),
-    renderTime(size), primCount(size) { }
+    renderTime(size), primCount(size), drawCalls(size), allocations(size),
+    stageTimes(size_t(ProfileStage::MAX), RollingSampler<TimeDiff>(size)),
+    historySize(historySize) { }
+
+void Profiler::record(const ProfileStage stage, const TimeDiff time) {
+  std::lock_guard<std::mutex> lock(mutex);
+  current.stages[size_t(stage)] += time;
+}
+
+void Profiler::endFrame() {
+  ProfileRow row;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    row = current;
+    current = ProfileRow();
+  }
+
+  auto &stages = row.stages;
+  stages[size_t(ProfileStage::UIRender)] = std::max(
+      0.0f, stages[size_t(ProfileStage::Render)]
+          - stages[size_t(ProfileStage::SkyRender)]);
+  for (size_t i = 0; i < stages.size(); ++i) stageTimes[i].push(stages[i]);
+
+  const size_t totalAllocations = allocationCount();
+  row.allocations = totalAllocations - lastAllocations;
+  lastAllocations = totalAllocations;
+  allocations.push(row.allocations);
+
+  if (cycleTime.size()) row.cycleTime = cycleTime.getData().back();
+  if (primCount.size()) row.primCount = primCount.getData().back();
+  if (drawCalls.size()) row.drawCalls = drawCalls.getData().back();
+
+  if (history.size() >= historySize) history.pop_front();
+  history.push_back(row);
+}
+
+bool Profiler::writeCSV(const std::string &path) const {
+  std::ofstream file(path);
+  if (!file) return false;
+
+  file << "frame,cycle";
+  for (size_t i = 0; i < size_t(ProfileStage::MAX); ++i)
+    file << "," << showProfileStage(ProfileStage(i));
+  file << ",prims,draws,allocations\n";
+
+  size_t frame = 0;
+  for (const auto &row : history) {
+    file << frame++ << "," << row.cycleTime;
+    for (const auto time : row.stages) file << "," << time;
+    file << "," << row.primCount << "," << row.drawCalls
+        << "," << row.allocations << "\n";
+  }
+
+  return bool(file);
+}
 
 ProfilerSnapshot::ProfilerSnapshot(const Profiler &profiler) :
     cycleTime(profiler.cycleTime), logicTime(profiler.logicTime),
-    renderTime(profiler.renderTime) { }
+    renderTime(profiler.renderTime),
+    primCount(profiler.primCount.mean<double>()),
+    drawCalls(profiler.drawCalls.mean<double>()),
+    stageTimes(profiler.stageTimes.begin(), profiler.stageTimes.end()),
+    allocations(profiler.allocations.mean<double>()),
+    recentCycles(profiler.cycleTime.getData()) { }
 
 /**
  * AppState.
@@ -41,18 +102,26 @@ ProfilerSnapshot::ProfilerSnapshot(const Profiler &profiler) :
 AppRefs::AppRefs(Settings &settings,
                  const AppResources &resources,
                  const Time &time,
-                 const sf::RenderWindow &window,
+                 const float &tickAlpha,
+                 const TimeDiff tickStep,
+                 const sf::RenderTarget &target,
                  const Profiler &profiler) :
     settings(settings),
     resources(resources),
     uptime(time),
-    window(window),
+    tickAlpha(tickAlpha),
+    tickStep(tickStep),
+    target(target),
     profiler(profiler) { }
 
 double AppRefs::timeSince(const Time event) const {
   return uptime - event;
 }
 
+TimeDiff AppRefs::sinceTick() const {
+  return tickAlpha * tickStep;
+}
+
 /**
  * Control.
  */
@@ -88,6 +157,11 @@ void Control::reset() {
   for (auto child : children) child->reset();
 }
 
+bool Control::animating() const {
+  for (auto child : children) if (child->animating()) return true;
+  return false;
+}
+
 void Control::signalRead() { // process signals
   for (auto child : children) child->signalRead();
 }
@@ -107,12 +181,17 @@ void ControlExec::tick() {
 
   profileClock.restart();
   rollingTickTime += cycleDelta;
-  ctrl->poll();
+  {
+    ProfileScope scope(ProfileStage::Poll);
+    ctrl->poll();
+  }
 
   while (rollingTickTime > tickStep) {
+    ProfileScope scope(ProfileStage::Tick);
     ctrl->tick(tickStep);
     rollingTickTime -= tickStep;
   }
+  tickAlpha = rollingTickTime / tickStep;
 
   profiler.logicTime.push(profileClock.restart().asSeconds());
 
@@ -126,12 +205,13 @@ void ControlExec::tick() {
 }
 
 void ControlExec::handle() {
+  ProfileScope scope(ProfileStage::Events);
   static sf::Event event;
   while (window.pollEvent(event)) {
     switch (event.type) {
       case sf::Event::Closed:
         appLog("Caught close signal.", LogOrigin::App);
-        window.close();
+        closing = true;
         break;
       case sf::Event::Resized:
         resizeCooldown.reset();
@@ -141,10 +221,6 @@ void ControlExec::handle() {
         ctrl->reset();
         break;
 
-      case sf::Event::MouseWheelScrolled:
-        // fk mouse wheels
-        break;
-
       default:
         ctrl->handle(transformEvent(frame.windowToFrame, event));
         ctrl->signalRead();
@@ -154,13 +230,23 @@ void ControlExec::handle() {
   }
 }
 
-void ControlExec::renderAndSleep() {
-  frame.beginDraw();
+void ControlExec::recordFrame(DrawList &list) {
+  frame.beginDraw(list);
   profileClock.restart();
-  ctrl->render(frame);
+  {
+    ProfileScope scope(ProfileStage::Render);
+    ctrl->render(frame);
+  }
   profiler.renderTime.push(profileClock.restart().asSeconds());
   profiler.primCount.push(frame.primCount);
   frame.endDraw();
+  profiler.drawCalls.push(frame.drawCalls);
+}
+
+void ControlExec::renderAndSleep() {
+  recordFrame(drawList);
+  ProfileScope scope(ProfileStage::Display);
+  drawList.replay(window);
   window.display();
   // window.display() doesn't seem to block when the window isn't focused
   // on certain platforms
@@ -195,9 +281,12 @@ ControlExec::ControlExec() :
     frame(window),
     resizeCooldown(0.5),
 
+    closing(false),
+
     uptime(0),
     tickStep(1.0f / 60.0f),
     rollingTickTime(0),
+    tickAlpha(0),
 
     profiler(100),
 
@@ -207,7 +296,8 @@ ControlExec::ControlExec() :
 
     #pragma clang diagnostic push
     #pragma clang diagnostic ignored "-Wnull-dereference"
-    appState(settings, *((AppResources *) nullptr), uptime, window, profiler) {
+    appState(settings, *((AppResources *) nullptr), uptime, tickAlpha, tickStep,
+             window, profiler) {
     #pragma clang diagnostic pop
   window.setVerticalSyncEnabled(true);
   window.setKeyRepeatEnabled(false);
@@ -221,16 +311,21 @@ ControlExec::~ControlExec() {
 
 void ControlExec::run(std::function<std::unique_ptr<Control>(const AppRefs &)> mkApp) {
   ctrl = std::make_unique<detail::SplashScreen>(appState, mkApp);
+  setProfileSink(&profiler);
   appLog("Starting application loop...", LogOrigin::App);
 
-  while (window.isOpen()) {
+  while (!closing) {
     tick();
     handle();
     renderAndSleep();
+    profiler.endFrame();
 
-    if (ctrl->quitting) window.close();
+    if (ctrl->quitting) closing = true;
   }
 
+  setProfileSink(nullptr);
+  window.close();
+
   appLog("Exiting cleanly.", LogOrigin::App);
 }
 
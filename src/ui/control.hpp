@@ -23,21 +23,54 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <array>
+#include <deque>
 #include "util/telegraph.hpp"
+#include "util/profiling.hpp"
 #include "frame.hpp"
 #include "settings.hpp"
 #include "resources.hpp"
 
 namespace ui {
 
+/**
+ * One frame's worth of profile data, as kept in the Profiler's history.
+ */
+struct ProfileRow {
+  TimeDiff cycleTime = 0;
+  std::array<TimeDiff, size_t(ProfileStage::MAX)> stages{};
+  size_t primCount = 0, drawCalls = 0, allocations = 0;
+
+};
+
 /**
  * Manager for performance profile data collected by the game loop.
+ *
+ * Stage timings arrive through ProfileScopes, possibly from the render
+ * thread, and are summed into the current frame until endFrame().
  */
-struct Profiler {
-  Profiler(const unsigned int size);
+struct Profiler: public ProfileSink {
+ private:
+  std::mutex mutex;
+  ProfileRow current;
+  size_t lastAllocations;
+
+ public:
+  Profiler(const unsigned int size, const size_t historySize = 3600);
 
   RollingSampler<TimeDiff> cycleTime, logicTime, renderTime;
-  RollingSampler<size_t> primCount;
+  RollingSampler<size_t> primCount, drawCalls, allocations;
+  std::vector<RollingSampler<TimeDiff>> stageTimes;
+
+  // Every frame, oldest first, up to historySize.
+  const size_t historySize;
+  std::deque<ProfileRow> history;
+
+  void record(const ProfileStage stage, const TimeDiff time) override;
+  void endFrame();
+
+  // Write the history as CSV, one row per frame; false on failure.
+  bool writeCSV(const std::string &path) const;
 
 };
 
@@ -46,6 +79,10 @@ struct ProfilerSnapshot {
   ProfilerSnapshot(const Profiler &profiler);
 
   TimeStats cycleTime, logicTime, renderTime;
+  double primCount = 0, drawCalls = 0; // per frame, averaged
+  std::vector<TimeStats> stageTimes; // indexed by ProfileStage
+  double allocations = 0; // per frame, averaged
+  std::vector<TimeDiff> recentCycles; // oldest first, for graphing
 
 };
 
@@ -61,7 +98,9 @@ struct AppRefs {
   AppRefs(Settings &settings,
           const AppResources &resources,
           const Time &time,
-          const sf::RenderWindow &window,
+          const float &tickAlpha,
+          const TimeDiff tickStep,
+          const sf::RenderTarget &target,
           const Profiler &profiler);
 
   // References accessible from Control member variables.
@@ -70,10 +109,14 @@ struct AppRefs {
 
   // References only accessible from this struct.
   const Time &uptime;
-  const sf::RenderWindow &window;
+  const float &tickAlpha; // progress towards the next tick, in [0, 1)
+  const TimeDiff tickStep;
+  const sf::RenderTarget &target; // the window, or an offscreen texture
   const Profiler &profiler;
 
   double timeSince(const Time event) const;
+  // Time passed since the last tick, for rendering between ticks.
+  TimeDiff sinceTick() const;
 
 };
 
@@ -105,6 +148,11 @@ class Control {
   virtual bool handle(const sf::Event &event);
   virtual void reset();
 
+  // Whether the render changes from tick to tick on its own, without
+  // events: by default, whether any child's does. Retained renders are
+  // redrawn while this holds.
+  virtual bool animating() const;
+
   // Signal callbacks.
   virtual void signalRead();
   virtual void signalClear();
@@ -113,6 +161,9 @@ class Control {
 
 /**
  * Runs a top-level ui::Control, resulting in a full app.
+ *
+ * Each cycle polls and ticks the Control, records its render into a
+ * DrawList, and replays the list on the window.
  */
 class ControlExec {
  private:
@@ -127,11 +178,16 @@ class ControlExec {
   Frame frame;
   Cooldown resizeCooldown;
 
+  // Rendering.
+  DrawList drawList;
+  bool closing;
+
   // Timing.
   sf::Clock cycleClock;
   Time uptime;
   const TimeDiff tickStep;
   TimeDiff rollingTickTime;
+  float tickAlpha;
 
   // Profiling.
   sf::Clock profileClock;
@@ -144,6 +200,7 @@ class ControlExec {
   // App loop submethods.
   void tick();
   void handle();
+  void recordFrame(DrawList &list);
   void renderAndSleep();
 
  public:
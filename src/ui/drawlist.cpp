@@ -0,0 +1,91 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "drawlist.hpp"
+
+namespace ui {
+
+/**
+ * DrawList::Command.
+ */
+
+DrawList::Command::Command(const sf::PrimitiveType primitive,
+                           const sf::RenderStates &states,
+                           const size_t first, const size_t count) :
+    primitive(primitive),
+    states(states),
+    first(first),
+    count(count) { }
+
+DrawList::Command::Command(std::shared_ptr<const sf::Drawable> &&drawable,
+                           const sf::RenderStates &states) :
+    primitive(sf::PrimitiveType::Points),
+    states(states),
+    first(0),
+    count(0),
+    drawable(std::move(drawable)) { }
+
+/**
+ * DrawList.
+ */
+
+DrawList::DrawList() :
+    clearColor(sf::Color::Black) { }
+
+void DrawList::begin(const sf::View &view, const sf::Color &clearColor) {
+  this->view = view;
+  this->clearColor = clearColor;
+  vertices.clear();
+  commands.clear();
+}
+
+void DrawList::addVertices(const sf::Vertex *data, const size_t count,
+                           const sf::PrimitiveType primitive,
+                           const sf::RenderStates &states) {
+  if (count == 0) return;
+  commands.emplace_back(primitive, states, vertices.size(), count);
+  vertices.insert(vertices.end(), data, data + count);
+}
+
+void DrawList::addDrawable(std::shared_ptr<const sf::Drawable> drawable,
+                           const sf::RenderStates &states) {
+  if (!drawable) return;
+  commands.emplace_back(std::move(drawable), states);
+}
+
+void DrawList::replay(sf::RenderTarget &target) const {
+  target.setView(view);
+  target.clear(clearColor);
+  for (const auto &command : commands) {
+    if (command.drawable) {
+      target.draw(*command.drawable, command.states);
+    } else {
+      target.draw(vertices.data() + command.first, command.count,
+                  command.primitive, command.states);
+    }
+  }
+}
+
+size_t DrawList::drawCalls() const {
+  return commands.size();
+}
+
+size_t DrawList::vertexCount() const {
+  return vertices.size();
+}
+
+}
@@ -0,0 +1,71 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * A recorded frame of draw calls.
+ */
+#pragma once
+#include <memory>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+namespace ui {
+
+/**
+ * The draw calls of one frame, recorded by a Frame and replayed onto a render
+ * target. Holds everything it draws: vertex data
+ * by value, prepared geometry by shared_ptr. Textures are only pointed to,
+ * and must outlive it (AppResources' and fonts' do).
+ */
+class DrawList {
+ private:
+  struct Command {
+    Command(const sf::PrimitiveType primitive, const sf::RenderStates &states,
+            const size_t first, const size_t count);
+    Command(std::shared_ptr<const sf::Drawable> &&drawable,
+            const sf::RenderStates &states);
+
+    sf::PrimitiveType primitive;
+    sf::RenderStates states;
+    size_t first, count; // range in `vertices`
+    std::shared_ptr<const sf::Drawable> drawable; // drawn instead, if set
+  };
+
+  sf::View view;
+  sf::Color clearColor;
+  std::vector<sf::Vertex> vertices;
+  std::vector<Command> commands;
+
+ public:
+  DrawList();
+
+  // Recording.
+  void begin(const sf::View &view, const sf::Color &clearColor);
+  void addVertices(const sf::Vertex *data, const size_t count,
+                   const sf::PrimitiveType primitive,
+                   const sf::RenderStates &states);
+  void addDrawable(std::shared_ptr<const sf::Drawable> drawable,
+                   const sf::RenderStates &states);
+
+  // Clear the target and draw everything onto it.
+  void replay(sf::RenderTarget &target) const;
+  size_t drawCalls() const;
+  size_t vertexCount() const; // streamed, not counting prepared geometry
+
+};
+
+}
@@ -22,24 +22,94 @@
 
 namespace ui {
 
+namespace {
+
+// Vertices of a unit circle, with the same point count as sf::CircleShape.
+const std::vector<sf::Vector2f> &unitCircle() {
+  static const std::vector<sf::Vector2f> points = []() {
+    static constexpr size_t pointCount = 30;
+    std::vector<sf::Vector2f> points(pointCount);
+    for (size_t i = 0; i < pointCount; ++i) {
+      const float angle = float(i) * 2 * float(M_PI) / float(pointCount);
+      points[i] = {std::cos(angle), std::sin(angle)};
+    }
+    return points;
+  }();
+  return points;
+}
+
+}
+
 const sf::Color Frame::alphaScaleColor(const sf::Color &color) {
   sf::Color newColor(color);
   newColor.a *= alphaStack.top();
   return newColor;
 }
 
-Frame::Frame(sf::RenderWindow &window) : window(window) {
+void Frame::useTexture(const sf::Texture *texture) {
+  if (texture != batchTexture) {
+    flush();
+    batchTexture = texture;
+  }
+}
+
+void Frame::batchTriangle(const sf::Vertex &a, const sf::Vertex &b,
+                          const sf::Vertex &c) {
+  const auto &transform = transformStack.top();
+  for (auto vertex : {a, b, c}) {
+    vertex.position = transform.transformPoint(vertex.position);
+    batch.append(vertex);
+  }
+}
+
+void Frame::batchQuad(const sf::Vertex &topLeft, const sf::Vertex &topRight,
+                      const sf::Vertex &bottomRight,
+                      const sf::Vertex &bottomLeft) {
+  batchTriangle(topLeft, topRight, bottomRight);
+  batchTriangle(topLeft, bottomRight, bottomLeft);
+}
+
+void Frame::batchText(const TextLayout &layout, const sf::Vector2f &pos,
+                      const sf::Texture &texture, const sf::Color &fill,
+                      const optional<sf::Color> &outline) {
+  useTexture(&texture);
+  const auto &transform = transformStack.top();
+  const auto append = [&](const std::vector<sf::Vertex> &vertices,
+                          const sf::Color &color) {
+    for (const auto &vertex : vertices) {
+      batch.append(sf::Vertex(transform.transformPoint(pos + vertex.position),
+                              color, vertex.texCoords));
+    }
+  };
+  if (outline) append(layout.outline, outline.get());
+  append(layout.fill, fill);
+}
+
+void Frame::flush() {
+  if (batch.getVertexCount() == 0) return;
+  list->addVertices(&batch[0], batch.getVertexCount(),
+                    sf::PrimitiveType::Triangles,
+                    sf::RenderStates(batchTexture));
+  batch.clear();
+  drawCalls++;
+}
+
+Frame::Frame(sf::RenderTarget &target) :
+    batch(sf::PrimitiveType::Triangles),
+    batchTexture(nullptr),
+    list(nullptr),
+    target(target) {
   resize();
 }
 
 void Frame::resize() {
-  sf::Vector2u size = window.getSize();
+  sf::Vector2u size = target.getSize();
   float sx(size.x), sy(size.y);
   const float viewAspect = sx / sy;
   static constexpr float targetAspect = 16.0f / 9.0f;
 
-  // set the view
-  sf::View view;
+  // set the view, carried to the window by each DrawList
+  view = sf::View();
   view.setCenter(800, 450);
   if (viewAspect > targetAspect) {
     view.setSize(1600 * (viewAspect / targetAspect), 900);
@@ -53,19 +123,21 @@ void Frame::resize() {
     windowToFrame = sf::Transform().scale(scalar, scalar);
     windowToFrame.translate(0, -(sy - (sx / targetAspect)) / 2);
   }
-
-  window.setView(view);
 }
 
-void Frame::beginDraw() {
+void Frame::beginDraw(DrawList &list) {
+  this->list = &list;
+  list.begin(view, sf::Color::Black);
   primCount = 0;
+  drawCalls = 0;
+  batch.clear();
+  batchTexture = nullptr;
   transformStack = std::stack<sf::Transform>({sf::Transform::Identity});
   alphaStack = std::stack<float>({1});
-  window.clear(sf::Color::Black);
 }
 
 void Frame::endDraw() {
-  sf::Vector2u size = window.getSize();
+  sf::Vector2u size = target.getSize();
   sf::Vector2f topLeft = windowToFrame.transformPoint(sf::Vector2f(0, 0));
   sf::Vector2f bottomRight = windowToFrame.transformPoint(
       sf::Vector2f(size));
@@ -76,6 +148,8 @@ void Frame::endDraw() {
   drawRect(sf::Vector2f(1600, 0), bottomRight, color);
   drawRect(topLeft, sf::Vector2f(1600, 0), color);
   drawRect(sf::Vector2f(0, 900), bottomRight, color);
+  flush();
+  list = nullptr;
 }
 
 void Frame::pushTransform(const sf::Transform &transform) {
@@ -122,50 +196,57 @@ void Frame::drawCircle(const sf::Vector2f &pos,
                        const float radius,
                        const sf::Color &color) {
   primCount++;
-  sf::CircleShape circle(radius);
-  circle.setPosition(pos - sf::Vector2f(radius, radius));
-  circle.setFillColor(alphaScaleColor(color));
-  window.draw(circle, transformStack.top());
+  useTexture(nullptr);
+  const sf::Color col = alphaScaleColor(color);
+  const auto &circle = unitCircle();
+  const sf::Vertex center(pos, col);
+  for (size_t i = 0; i < circle.size(); ++i) {
+    batchTriangle(center,
+                  sf::Vertex(pos + radius * circle[i], col),
+                  sf::Vertex(pos + radius * circle[(i + 1) % circle.size()],
+                             col));
+  }
 }
 
 void Frame::drawRect(const sf::Vector2f &topLeft,
                      const sf::Vector2f &bottomRight,
                      const sf::Color &color) {
   primCount++;
-  sf::RectangleShape rect(bottomRight - topLeft);
-  rect.setPosition(topLeft);
-  rect.setFillColor(alphaScaleColor(color));
-  window.draw(rect, transformStack.top());
+  useTexture(nullptr);
+  const sf::Color col = alphaScaleColor(color);
+  batchQuad(sf::Vertex(topLeft, col),
+            sf::Vertex({bottomRight.x, topLeft.y}, col),
+            sf::Vertex(bottomRight, col),
+            sf::Vertex({topLeft.x, bottomRight.y}, col));
 }
 
 void Frame::drawPoly(const std::vector<sf::Vector2f> &vertices,
                      const sf::Color &color) {
   primCount++;
-  sf::ConvexShape shape(vertices.size());
-  size_t i = 0;
-  for (const auto &vertex : vertices) {
-    shape.setPoint(i, vertex);
-    ++i;
+  if (vertices.size() < 3) return;
+  useTexture(nullptr);
+  // Convex, so a fan from the first vertex covers it.
+  const sf::Color col = alphaScaleColor(color);
+  for (size_t i = 1; i + 1 < vertices.size(); ++i) {
+    batchTriangle(sf::Vertex(vertices[0], col),
+                  sf::Vertex(vertices[i], col),
+                  sf::Vertex(vertices[i + 1], col));
   }
-  shape.setFillColor(alphaScaleColor(color));
-  window.draw(shape, transformStack.top());
 }
 
 void Frame::drawPolyOutline(const std::vector<sf::Vector2f> &vertices,
                             const sf::Color &color) {
   primCount++;
+  if (vertices.empty()) return;
   std::vector<sf::Vertex> shape(vertices.size() + 1);
-  sf::Color col = alphaScaleColor(color);
-  size_t i = 0;
-  for (const auto &vertex : vertices) {
-    shape[i] = sf::Vertex(vertex, col);
-    ++i;
-  }
+  const sf::Color col = alphaScaleColor(color);
+  for (size_t i = 0; i < vertices.size(); ++i)
+    shape[i] = sf::Vertex(vertices[i], col);
   shape[vertices.size()] = sf::Vertex(vertices[0], col);
-  window.draw(shape.data(),
-              shape.size(),
-              sf::PrimitiveType::LinesStrip,
-              transformStack.top());
+  flush();
+  list->addVertices(shape.data(), shape.size(), sf::PrimitiveType::LinesStrip,
+                    transformStack.top());
+  drawCalls++;
 }
 
 sf::Vector2f Frame::drawText(const sf::Vector2f &pos,
@@ -181,15 +262,92 @@ void Frame::drawSprite(const sf::Texture &texture,
                        const sf::Vector2f &pos,
                        const sf::IntRect &portion) {
   primCount++;
-  sf::Sprite sprite;
-  sprite.setTexture(texture);
-  sprite.setPosition(pos);
-  sprite.setTextureRect(portion);
-  sprite.setColor(sf::Color(255,
-                            255,
-                            255,
-                            (sf::Uint8) (255 * alphaStack.top())));
-  window.draw(sprite, transformStack.top());
+  useTexture(&texture);
+  const sf::Color col(255, 255, 255, (sf::Uint8) (255 * alphaStack.top()));
+  const float width = float(std::abs(portion.width)),
+      height = float(std::abs(portion.height));
+  const float left = float(portion.left), top = float(portion.top),
+      right = left + float(portion.width), bottom = top + float(portion.height);
+  batchQuad(sf::Vertex(pos, col, {left, top}),
+            sf::Vertex(pos + sf::Vector2f(width, 0), col, {right, top}),
+            sf::Vertex(pos + sf::Vector2f(width, height), col, {right, bottom}),
+            sf::Vertex(pos + sf::Vector2f(0, height), col, {left, bottom}));
+}
+
+void Frame::drawStatic(std::shared_ptr<const sf::Drawable> geometry,
+                       const sf::Texture *texture) {
+  primCount++;
+  flush();
+  sf::RenderStates states(transformStack.top());
+  states.texture = texture;
+  list->addDrawable(std::move(geometry), states);
+  drawCalls++;
+}
+
+void Frame::drawCached(RenderCache &cache, std::function<void()> draw) {
+  const sf::Vector2u size = target.getSize();
+  if (cache.isDirty() or cache.size != size) {
+    // Record the content into a list of its own, from a clean slate.
+    flush();
+    auto content = std::make_shared<DrawList>();
+    content->begin(sf::View(sf::FloatRect(0, 0, 1600, 900)),
+                   sf::Color::Transparent);
+    DrawList *const outer = list;
+    const sf::Texture *const outerTexture = batchTexture;
+    list = content.get();
+    batchTexture = nullptr;
+    transformStack.push(sf::Transform::Identity);
+    alphaStack.push(1);
+
+    draw();
+    flush();
+
+    alphaStack.pop();
+    transformStack.pop();
+    list = outer;
+    batchTexture = outerTexture;
+    cache.store(std::move(content), size);
+  }
+
+  // The rasterizer runs at replay, before the quad sampling its texture.
+  flush();
+  list->addDrawable(cache.rasterizer, sf::RenderStates());
+
+  // Content drawn over a transparent clear comes out premultiplied, and is
+  // blended as such; the alpha scales every channel.
+  const sf::Uint8 alpha = sf::Uint8(255 * alphaStack.top());
+  const sf::Color color(alpha, alpha, alpha, alpha);
+  const sf::Vector2f texSize(cache.size);
+  const sf::Vertex topLeft({0, 0}, color, {0, 0}),
+      topRight({1600, 0}, color, {texSize.x, 0}),
+      bottomRight({1600, 900}, color, texSize),
+      bottomLeft({0, 900}, color, {0, texSize.y});
+  const sf::Vertex quad[6] =
+      {topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft};
+
+  sf::RenderStates states(
+      sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha),
+      transformStack.top(), &cache.getTexture(), nullptr);
+  list->addVertices(quad, 6, sf::PrimitiveType::Triangles, states);
+  primCount++;
+  drawCalls++;
+}
+
+void Frame::addCommand(std::shared_ptr<const sf::Drawable> command) {
+  flush();
+  list->addDrawable(std::move(command), sf::RenderStates());
+}
+
+void Frame::drawVertices(const sf::Vertex *vertices, const size_t count,
+                         const sf::PrimitiveType primitive,
+                         const sf::Texture *texture) {
+  if (count == 0) return;
+  primCount++;
+  flush();
+  sf::RenderStates states(transformStack.top());
+  states.texture = texture;
+  list->addVertices(vertices, count, primitive, states);
+  drawCalls++;
 }
 
 }
@@ -17,6 +17,13 @@
  */
 /**
  * A screen we can draw to.
+ *
+ * Primitives and text are transformed on the CPU and collected into a
+ * triangle batch, which becomes one draw call whenever the texture changes, or
+ * something that can't be batched (polygon outlines) needs to be drawn over
+ * it. Draw calls are recorded into a DrawList, for ControlExec to replay on
+ * the window. A benchmark can record and replay frames just the same onto an
+ * offscreen texture.
  */
 #pragma once
 #include <memory>
@@ -24,6 +31,9 @@
 #include <SFML/Graphics.hpp>
 #include <functional>
 #include "text.hpp"
+#include "textcache.hpp"
+#include "drawlist.hpp"
+#include "rendercache.hpp"
 
 namespace ui {
 class Control;
@@ -38,17 +48,41 @@ class Frame {
 
   const sf::Color alphaScaleColor(const sf::Color &);
 
+  // Batching.
+  sf::VertexArray batch;
+  const sf::Texture *batchTexture;
+  void useTexture(const sf::Texture *texture);
+  void batchTriangle(const sf::Vertex &a, const sf::Vertex &b,
+                     const sf::Vertex &c);
+  void batchQuad(const sf::Vertex &topLeft, const sf::Vertex &topRight,
+                 const sf::Vertex &bottomRight, const sf::Vertex &bottomLeft);
+  void batchText(const TextLayout &layout, const sf::Vector2f &pos,
+                 const sf::Texture &texture, const sf::Color &fill,
+                 const optional<sf::Color> &outline);
+  void flush();
+
+  // Recording.
+  DrawList *list;
+  sf::View view;
+
+  // Text layouts, kept between frames.
+  TextCache textCache;
+
   // Used by runSFML.
   sf::Transform windowToFrame;
-  size_t primCount;
-  void beginDraw();
-  void endDraw();
   void resize();
 
  public:
-  Frame(sf::RenderWindow &window);
+  Frame(sf::RenderTarget &target);
 
-  sf::RenderWindow &window; // might be useful for settings
+  // Might be useful for settings. Don't draw to it or set its view; that's
+  // for the DrawList's replay.
+  sf::RenderTarget &target;
+
+  // Recording a frame; ControlExec does this around Control::render.
+  size_t primCount, drawCalls;
+  void beginDraw(DrawList &list);
+  void endDraw();
 
   // Managing transform / alpha stack.
   void pushTransform(const sf::Transform &transform);
@@ -94,6 +128,30 @@ class Frame {
                         const sf::Font &font);
   void drawSprite(const sf::Texture &texture, const sf::Vector2f &pos,
                   const sf::IntRect &portion);
+
+  // Drawing API: prepared geometry (vertex arrays and buffers), drawn in one
+  // call under the current transform. The alpha stack doesn't apply. Shared,
+  // since the frame may be replayed after the caller lets go of it.
+  void drawStatic(std::shared_ptr<const sf::Drawable> geometry,
+                  const sf::Texture *texture = nullptr);
+
+  // Drawing API: a vertex array built by the caller each frame, copied into
+  // the frame and drawn in one call under the current transform. The alpha
+  // stack doesn't apply.
+  void drawVertices(const sf::Vertex *vertices, const size_t count,
+                    const sf::PrimitiveType primitive,
+                    const sf::Texture *texture = nullptr);
+
+  // Drawing API: retained content. `draw` draws the 1600 x 900 content,
+  // and is only called when the cache is dirty or the window was resized;
+  // otherwise the cached texture is drawn as one quad, under the current
+  // transform and alpha.
+  void drawCached(RenderCache &cache, std::function<void()> draw);
+
+  // Work for the thread replaying the frame, in order with the drawing
+  // around it: a Drawable that does GL work, like uploading a texture,
+  // rather than drawing.
+  void addCommand(std::shared_ptr<const sf::Drawable> command);
 };
 
 }
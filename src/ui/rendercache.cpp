@@ -0,0 +1,88 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "rendercache.hpp"
+#include "util/printer.hpp"
+
+namespace ui {
+
+/**
+ * RenderCache::Rasterizer.
+ */
+
+void RenderCache::Rasterizer::draw(sf::RenderTarget &target,
+                                   sf::RenderStates states) const {
+  if (layer->version == version) return;
+
+  if (layer->texture.getSize() != size) {
+    if (!layer->texture.create(size.x, size.y)) {
+      appLog("Could not create a render texture for a RenderCache!",
+             LogOrigin::App);
+      return;
+    }
+  }
+
+  content->replay(layer->texture);
+  layer->texture.display();
+  layer->version = version;
+}
+
+RenderCache::Rasterizer::Rasterizer(std::shared_ptr<Layer> layer,
+                                    std::shared_ptr<const DrawList> content,
+                                    const sf::Vector2u &size,
+                                    const size_t version) :
+    layer(std::move(layer)),
+    content(std::move(content)),
+    size(size),
+    version(version) { }
+
+/**
+ * RenderCache.
+ */
+
+void RenderCache::store(std::shared_ptr<const DrawList> content,
+                        const sf::Vector2u &size) {
+  this->size = size;
+  version++;
+  dirty = false;
+  rasterizer = std::make_shared<const Rasterizer>(
+      layer, std::move(content), size, version);
+}
+
+const sf::Texture &RenderCache::getTexture() const {
+  // Only the address is taken here, the texture may still be empty.
+  return layer->texture.getTexture();
+}
+
+RenderCache::RenderCache() :
+    layer(std::make_shared<Layer>()),
+    version(0),
+    dirty(true) { }
+
+void RenderCache::invalidate() {
+  dirty = true;
+}
+
+bool RenderCache::isDirty() const {
+  return dirty;
+}
+
+size_t RenderCache::recordCount() const {
+  return version;
+}
+
+}
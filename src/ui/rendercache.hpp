@@ -0,0 +1,87 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Retained rendering: keeping what a Control drew until it changes.
+ */
+#pragma once
+#include <memory>
+#include <SFML/Graphics.hpp>
+#include "drawlist.hpp"
+
+namespace ui {
+
+/**
+ * The cached render of some content, for Frame::drawCached.
+ *
+ * While the cache is clean, the Frame skips recording the content and draws
+ * the cached texture as a single quad. When it's dirty, the content is
+ * recorded again into a DrawList of its own. Rasterizing that list into the
+ * texture is itself a draw command, run when the frame is replayed: the
+ * texture is only ever touched by the thread that owns the GL context.
+ */
+class RenderCache {
+  friend class Frame;
+ private:
+  // Touched only by the replaying thread.
+  struct Layer {
+    sf::RenderTexture texture;
+    size_t version = 0; // of the content rasterized into the texture
+  };
+
+  // Brings the layer up to date with some recorded content; draws nothing
+  // onto the target itself.
+  class Rasterizer: public sf::Drawable {
+   private:
+    const std::shared_ptr<Layer> layer;
+    const std::shared_ptr<const DrawList> content;
+    const sf::Vector2u size;
+    const size_t version;
+
+   protected:
+    void draw(sf::RenderTarget &target,
+              sf::RenderStates states) const override;
+
+   public:
+    Rasterizer(std::shared_ptr<Layer> layer,
+               std::shared_ptr<const DrawList> content,
+               const sf::Vector2u &size,
+               const size_t version);
+
+  };
+
+  std::shared_ptr<Layer> layer;
+  std::shared_ptr<const Rasterizer> rasterizer;
+  sf::Vector2u size; // in pixels, of the recorded content
+  size_t version;
+  bool dirty;
+
+  // Used by Frame.
+  void store(std::shared_ptr<const DrawList> content,
+             const sf::Vector2u &size);
+  const sf::Texture &getTexture() const;
+
+ public:
+  RenderCache();
+
+  void invalidate();
+  bool isDirty() const;
+  size_t recordCount() const; // how many times the content was recorded
+
+};
+
+}
@@ -18,6 +18,7 @@
 #include <assert.h>
 #include "util/clientutil.hpp"
 #include "resources.hpp"
+#include "frame.hpp"
 #include "util/methods.hpp"
 #include "util/printer.hpp"
 #include "util/filepath.hpp"
@@ -93,15 +94,30 @@ const std::map<TextureID, TextureMetadata> textureMetadata{
 
 }
 
+/**
+ * TextureHandle.
+ */
+
+TextureHandle::TextureHandle(ResourceLoader &loader, const TextureID id) :
+    loader(&loader), id(id) { }
+
+const sf::Texture &TextureHandle::get() const {
+  return loader->requestTexture(id);
+}
+
+bool TextureHandle::isReady() const {
+  return loader->isResident(id);
+}
+
 /**
  * AppResources.
  */
 
 AppResources::AppResources(
     const std::map<FontID, sf::Font> &fonts,
-    const std::map<TextureID, sf::Texture> &textures) :
+    ResourceLoader &loader) :
     fonts(fonts),
-    textures(textures),
+    loader(loader),
     defaultFont(getFont(FontID::Default)) {}
 
 const FontMetadata &AppResources::getFontData(const FontID id) const {
@@ -115,30 +131,82 @@ const TextureMetadata &AppResources::getTextureData(const TextureID id) const {
 const sf::Font &AppResources::getFont(const FontID id) const {
   return fonts.at(id);
 }
+
 const sf::Texture &AppResources::getTexture(const TextureID id) const {
-  return textures.at(id);
+  return loader.requestTexture(id);
+}
+
+TextureHandle AppResources::getTextureHandle(const TextureID id) const {
+  return TextureHandle(loader, id);
 }
 
+namespace detail {
+
 /**
- * ResourceLoader.
+ * TextureSlot.
  */
 
-optional<std::string> ResourceLoader::loadTexture(
-    const TextureID id,
-    const TextureMetadata &metadata) {
-  if (textures[id].loadFromFile(getMediaPath(metadata.url).string())) {
-    return {};
-  } else {
-    textures.erase(textures.find(id));
-    loadingErrored = true;
-    return std::string("Texture did not load correctly.");
+TextureSlot::TextureSlot(const TextureID id) :
+    id(id),
+    state(TextureState::Unloaded),
+    bytes(0),
+    pinned(false),
+    lastUsed(0) { }
+
+/**
+ * Frame commands that move a texture between the GPU and the slot, run by
+ * the thread replaying the frame. The loader adds them every frame until
+ * they've been run.
+ */
+class TextureUpload: public sf::Drawable {
+ private:
+  const std::shared_ptr<TextureSlot> slot;
+
+ protected:
+  void draw(sf::RenderTarget &, sf::RenderStates) const override {
+    upload();
   }
+
+ public:
+  TextureUpload(const std::shared_ptr<TextureSlot> &slot) : slot(slot) { }
+
+  void upload() const {
+    if (slot->state != TextureState::Decoded) return;
+    if (slot->texture.loadFromImage(slot->image)) {
+      slot->image = sf::Image();
+      slot->state = TextureState::Resident;
+    } else {
+      appLog("Could not upload texture: "
+                 + textureMetadata.at(slot->id).url, LogOrigin::Error);
+      slot->state = TextureState::Failed;
+    }
+  }
+};
+
+class TextureEviction: public sf::Drawable {
+ private:
+  const std::shared_ptr<TextureSlot> slot;
+
+ protected:
+  void draw(sf::RenderTarget &, sf::RenderStates) const override {
+    if (slot->state != TextureState::Evicting) return;
+    slot->texture = sf::Texture();
+    slot->state = TextureState::Unloaded;
+  }
+
+ public:
+  TextureEviction(const std::shared_ptr<TextureSlot> &slot) : slot(slot) { }
+};
+
 }
 
+/**
+ * ResourceLoader.
+ */
+
 optional<std::string> ResourceLoader::loadFont(
     const FontID id,
     const FontMetadata &metadata) {
-  sf::Font font;
   if (fonts[id].loadFromFile(getMediaPath(metadata.url).string())) {
     return {};
   } else {
@@ -148,54 +216,75 @@ optional<std::string> ResourceLoader::loadFont(
   }
 }
 
-void ResourceLoader::loadAllBlocking() {
-  const size_t totalWork{
-      detail::fontMetadata.size() + detail::textureMetadata.size()};
-  size_t finishedWork{0};
-
-  appLog("** Loading fonts. **", LogOrigin::App);
+optional<std::string> ResourceLoader::loadTexture(detail::TextureSlot &slot) {
+  const auto &metadata = detail::textureMetadata.at(slot.id);
+  if (slot.texture.loadFromFile(getMediaPath(metadata.url).string())) {
+    const auto size = slot.texture.getSize();
+    slot.bytes = size_t(size.x) * size_t(size.y) * 4;
+    slot.state = detail::TextureState::Resident;
+    return {};
+  } else {
+    slot.state = detail::TextureState::Failed;
+    return std::string("Texture did not load correctly.");
+  }
+}
 
-  for (const auto &font : detail::fontMetadata) {
-    appLog("Loading font: " + font.second.url
-               + " (" + font.second.name + ").",
-           LogOrigin::App);
-    if (auto error = loadFont(font.first, font.second)) {
-      appLog("Error loading font: " + error.get(),
-             LogOrigin::App);
-      return;
+void ResourceLoader::startDecoding(detail::TextureSlot &slot,
+                                   const TaskPriority priority) {
+  slot.state = detail::TextureState::Decoding;
+  const auto shared = textures.at(slot.id);
+  const std::string url = detail::textureMetadata.at(slot.id).url;
+  slot.decoding = TaskPool::global().submit([shared, url]() {
+    if (shared->image.loadFromFile(getMediaPath(url).string())) {
+      const auto size = shared->image.getSize();
+      shared->bytes = size_t(size.x) * size_t(size.y) * 4;
+      shared->state = detail::TextureState::Decoded;
+    } else {
+      appLog("Error loading texture: " + url, LogOrigin::Error);
+      shared->state = detail::TextureState::Failed;
     }
-    loadingProgress = float(++finishedWork) / float(totalWork);
-  }
+  }, {}, priority);
+}
 
-  appLog("** Loading textures. **", LogOrigin::App);
+void ResourceLoader::enforceBudget() {
+  // Textures used within the last few seconds are staying either way.
+  static const size_t grace = 300;
+
+  size_t bytes = residentBytes();
+  while (bytes > textureBudget) {
+    detail::TextureSlot *oldest = nullptr;
+    for (auto &texture : textures) {
+      auto &slot = *texture.second;
+      if (slot.pinned or slot.state != detail::TextureState::Resident
+          or slot.lastUsed + grace > frame) continue;
+      if (!oldest or slot.lastUsed < oldest->lastUsed) oldest = &slot;
+    }
+    if (!oldest) return;
 
-  for (const auto &texture : detail::textureMetadata) {
-    appLog("Loading texture: " + texture.second.url
-               + " (" + texture.second.name + ")",
+    appLog("Evicting texture: " + detail::textureMetadata.at(oldest->id).url,
            LogOrigin::App);
-    if (auto error = loadTexture(texture.first, texture.second)) {
-      appLog("Error loading texture: " + error.get(),
-             LogOrigin::App);
-      return;
-    }
-    loadingProgress = float(++finishedWork) / float(totalWork);
+    oldest->state = detail::TextureState::Evicting;
+    bytes -= oldest->bytes;
   }
-
-  holder.emplace(fonts, textures);
-
-  appLog("** Finished resource loading. **", LogOrigin::App);
 }
 
 ResourceLoader::ResourceLoader(
-    std::initializer_list<FontID> bootstrapFonts,
     std::initializer_list<TextureID> bootstrapTextures) :
-  loadingProgress(0),
-  loadingErrored(false) {
-  // TODO: move resource metadata checks to compile-time?
-  for (const auto font : bootstrapFonts) {
-    assert(detail::fontMetadata.find(font)
-               != detail::fontMetadata.end());
-    if (auto error = loadFont(font, detail::fontMetadata.at(font))) {
+    frame(0),
+    textureBudget(256 * 1024 * 1024),
+    loadingProgress(0),
+    loadingErrored(false) {
+  for (const auto &texture : detail::textureMetadata) {
+    textures.emplace(texture.first,
+                     std::make_shared<detail::TextureSlot>(texture.first));
+  }
+
+  sf::Image transparent;
+  transparent.create(1, 1, sf::Color::Transparent);
+  placeholder.loadFromImage(transparent);
+
+  for (const auto &font : detail::fontMetadata) {
+    if (auto error = loadFont(font.first, font.second)) {
       appLog("Error loading bootstrap font: " + error.get(), LogOrigin::App);
       loadingErrored = true;
       return;
@@ -203,19 +292,25 @@ ResourceLoader::ResourceLoader(
   }
 
   for (const auto texture : bootstrapTextures) {
-    assert(detail::textureMetadata.find(texture)
-               != detail::textureMetadata.end());
-    if (auto error = loadTexture(texture, detail::textureMetadata.at(texture))) {
+    assert(textures.find(texture) != textures.end());
+    auto &slot = *textures.at(texture);
+    slot.pinned = true;
+    if (auto error = loadTexture(slot)) {
       appLog("Error loading bootstrap texture: " + error.get(), LogOrigin::App);
       loadingErrored = true;
       return;
     }
   }
+
+  holder.emplace(fonts, *this);
   appLog("Loaded bootstrap resources.", LogOrigin::App);
 }
 
 ResourceLoader::~ResourceLoader() {
-  if (workingThread.joinable()) workingThread.join();
+  for (const auto &texture : textures) {
+    if (texture.second->decoding)
+      TaskPool::global().wait(texture.second->decoding);
+  }
 }
 
 const sf::Font &ResourceLoader::accessFont(const FontID id) {
@@ -223,24 +318,108 @@ const sf::Font &ResourceLoader::accessFont(const FontID id) {
 }
 
 const sf::Texture &ResourceLoader::accessTexture(const TextureID id) {
-  return textures.at(id);
+  return textures.at(id)->texture;
 }
 
-void ResourceLoader::loadAllThreaded() {
-  workingThread = std::thread([this]() { loadAllBlocking(); });
+const sf::Texture &ResourceLoader::requestTexture(const TextureID id) {
+  auto &slot = *textures.at(id);
+  slot.lastUsed = frame;
+  switch (slot.state) {
+    case detail::TextureState::Resident:
+      return slot.texture;
+    case detail::TextureState::Unloaded: {
+      startDecoding(slot, TaskPriority::High);
+      break;
+    }
+    default:
+      break;
+  }
+  return placeholder;
 }
 
-float ResourceLoader::getProgress() const {
-  return loadingProgress;
+bool ResourceLoader::isResident(const TextureID id) const {
+  return textures.at(id)->state == detail::TextureState::Resident;
+}
+
+void ResourceLoader::stream(Frame &f) {
+  // Uploads are spread over frames, to keep the hitch of each one small.
+  static const size_t uploadsPerFrame = 2;
+
+  frame++;
+  size_t uploads = 0, finished = 0;
+  for (auto &texture : textures) {
+    const auto &slot = texture.second;
+    switch (slot->state) {
+      case detail::TextureState::Decoded: {
+        if (uploads++ < uploadsPerFrame)
+          f.addCommand(std::make_shared<detail::TextureUpload>(slot));
+        break;
+      }
+      case detail::TextureState::Evicting: {
+        f.addCommand(std::make_shared<detail::TextureEviction>(slot));
+        break;
+      }
+      case detail::TextureState::Resident: {
+        finished++;
+        break;
+      }
+      case detail::TextureState::Failed: {
+        // Decoding or uploading logged why; the app can't go on without it.
+        loadingErrored = true;
+        finished++;
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  enforceBudget();
+  loadingProgress = textures.empty()
+                    ? 1 : float(finished) / float(textures.size());
+}
+
+void ResourceLoader::setTextureBudget(const size_t bytes) {
+  textureBudget = bytes;
+}
+
+size_t ResourceLoader::residentBytes() const {
+  size_t bytes = 0;
+  for (const auto &texture : textures) {
+    const auto state = texture.second->state.load();
+    if (state == detail::TextureState::Decoded
+        or state == detail::TextureState::Resident)
+      bytes += texture.second->bytes;
+  }
+  return bytes;
 }
 
-void ResourceLoader::printNewLogs(Printer &p) {
-  logMutex.lock();
-  for (const auto &msg : workerLog) {
-    p.printLn(msg);
+void ResourceLoader::loadAllThreaded() {
+  // Behind anything requested in the meantime.
+  for (auto &texture : textures) {
+    if (texture.second->state == detail::TextureState::Unloaded)
+      startDecoding(*texture.second, TaskPriority::Low);
   }
-  workerLog.clear();
-  logMutex.unlock();
+}
+
+void ResourceLoader::loadAllBlocking() {
+  for (auto &texture : textures) {
+    auto &slot = *texture.second;
+    if (slot.decoding) TaskPool::global().wait(slot.decoding);
+    if (slot.state == detail::TextureState::Decoded) {
+      detail::TextureUpload(texture.second).upload();
+    } else if (slot.state == detail::TextureState::Unloaded) {
+      if (auto error = loadTexture(slot)) {
+        appLog("Error loading texture: " + error.get(), LogOrigin::App);
+      }
+    }
+    if (slot.state == detail::TextureState::Failed) loadingErrored = true;
+  }
+  loadingProgress = 1;
+}
+
+float ResourceLoader::getProgress() const {
+  return loadingProgress;
 }
 
 bool ResourceLoader::getErrorStatus() const {
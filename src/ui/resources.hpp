@@ -107,41 +107,105 @@ extern const std::map<TextureID, TextureMetadata> textureMetadata;
 
 }
 
+class ResourceLoader;
+
 /**
- * Access to the results of a successful resource loading.
+ * A texture that may still be streaming in, for holding on to past the
+ * frame: dereferencing it requests the texture, and gives a transparent
+ * placeholder until it's uploaded.
+ */
+class TextureHandle {
+ private:
+  ResourceLoader *loader;
+  TextureID id;
+
+ public:
+  TextureHandle() = delete;
+  TextureHandle(ResourceLoader &loader, const TextureID id);
+
+  const sf::Texture &get() const;
+  bool isReady() const;
+
+};
+
+/**
+ * Access to the results of a successful resource loading. Fonts are all
+ * loaded; textures are requested when they're accessed, and stream in.
  */
 class AppResources {
  private:
   const std::map<FontID, sf::Font> &fonts;
-  const std::map<TextureID, sf::Texture> &textures;
+  ResourceLoader &loader;
 
  public:
   AppResources(const std::map<FontID, sf::Font> &fonts,
-               const std::map<TextureID, sf::Texture> &textures);
+               ResourceLoader &loader);
 
   // Accessing data.
   const FontMetadata &getFontData(const FontID id) const;
   const TextureMetadata &getTextureData(const TextureID id) const;
   const sf::Font &getFont(const FontID id) const;
-  const sf::Texture &getTexture(const TextureID id) const;
+  const sf::Texture &getTexture(const TextureID id) const; // for this frame
+  TextureHandle getTextureHandle(const TextureID id) const;
 
   // Resource handles.
   const sf::Font &defaultFont;
 
 };
 
+namespace detail {
+
+/**
+ * Where a texture is in the streaming pipeline. Decoding happens on the
+ * TaskPool; uploading and eviction on the thread replaying frames.
+ */
+enum class TextureState {
+  Unloaded, Decoding, Decoded, Resident, Evicting, Failed
+};
+
 /**
- * Manages the loading of a set of resources, resulting in an AppResources.
+ * A texture and its streaming state. Everything but `state` belongs to
+ * whichever stage the state names: the image to the decoding task until
+ * it's Decoded, and then to the thread replaying frames, which uploads it;
+ * the texture is only read by the loader once it's Resident. The loader
+ * itself, recording frames, only ever looks at the state.
+ */
+struct TextureSlot {
+  TextureSlot(const TextureID id);
+
+  const TextureID id;
+  std::atomic<TextureState> state;
+  sf::Image image; // decoded, until it's uploaded
+  sf::Texture texture;
+  size_t bytes;
+
+  // Used by the loader.
+  bool pinned; // bootstrap textures are never evicted
+  size_t lastUsed; // frame it was last requested in
+  TaskHandle decoding;
+};
+
+}
+
+/**
+ * Manages the loading of resources, resulting in an AppResources.
+ *
+ * Fonts and the bootstrap textures are loaded up front, on construction;
+ * the AppResources is ready then. Other textures are decoded on the
+ * TaskPool, in the background after loadAllThreaded() and right away when
+ * they're requested, and uploaded by commands stream() adds to each frame.
+ * Once the textures take more than the budget, those that haven't been
+ * requested for a while are evicted, least recently used first; they're
+ * decoded again when requested.
  */
 class ResourceLoader {
  private:
   std::map<FontID, sf::Font> fonts;
-  std::map<TextureID, sf::Texture> textures;
-
-  std::thread workingThread;
-  std::vector<std::string> workerLog;
-  std::mutex logMutex;
+  std::map<TextureID, std::shared_ptr<detail::TextureSlot>> textures;
+  sf::Texture placeholder;
 
+  size_t frame;
+  size_t textureBudget; // bytes of uploaded or decoded textures
   float loadingProgress;
   bool loadingErrored;
   optional<AppResources> holder;
@@ -149,29 +213,33 @@ class ResourceLoader {
   // Loading subroutines.
   optional<std::string> loadFont(
       const FontID id, const FontMetadata &data);
-  optional<std::string> loadTexture(
-      const TextureID id, const TextureMetadata &data);
-  void loadAllBlocking();
+  optional<std::string> loadTexture(detail::TextureSlot &slot);
+  void startDecoding(detail::TextureSlot &slot, const TaskPriority priority);
+  void enforceBudget();
 
  public:
-  ResourceLoader(
-      std::initializer_list<FontID> bootstrapFonts,
-      std::initializer_list<TextureID> boostrapTextures);
+  ResourceLoader(std::initializer_list<TextureID> bootstrapTextures);
   ~ResourceLoader();
 
   // Accessing boostrapped resources.
   const sf::Font &accessFont(const FontID id);
   const sf::Texture &accessTexture(const TextureID id);
 
+  // Streaming textures.
+  const sf::Texture &requestTexture(const TextureID id);
+  bool isResident(const TextureID id) const;
+  void stream(class Frame &f); // once per frame, from the recording thread
+  void setTextureBudget(const size_t bytes);
+  size_t residentBytes() const;
+
   // Loading resources.
   void loadAllThreaded(); // non-blocking
+  void loadAllBlocking(); // with a GL context on this thread
   float getProgress() const;
-  void printNewLogs(Printer &p);
-  bool getErrorStatus() const;
+  bool getErrorStatus() const; // also once a streamed texture fails
 
   AppResources const *getHolder() const;
 
 };
 
 }
-
@@ -34,7 +34,7 @@ SheetLayout::SheetLayout(const sf::Vector2i &spriteDimensions,
  */
 
 SpriteSheet::SpriteSheet(const SheetLayout &layout,
-                         const sf::Texture &texture) :
+                         const TextureHandle &texture) :
     layout(layout),
     texture(texture),
     size(layout.tiling.x * layout.tiling.y) { }
@@ -49,7 +49,7 @@ void SpriteSheet::drawIndex(ui::Frame &f, const sf::Vector2f &dims,
   f.withTransform(
       sf::Transform().scale(dims.x / spriteWidth, dims.y / spriteHeight),
       [&] {
-        f.drawSprite(texture,
+        f.drawSprite(texture.get(),
                      {-float(spriteWidth) / 2.f, -float(spriteHeight) / 2.f},
                      sf::IntRect(left, top, spriteWidth, spriteHeight));
       });
@@ -27,13 +27,13 @@ namespace ui {
 class SpriteSheet {
  private:
   const SheetLayout &layout;
-  const sf::Texture &texture;
+  const TextureHandle texture;
 
  public:
   const int size;
 
   SpriteSheet() = delete;
-  SpriteSheet(const SheetLayout &layout, const sf::Texture &texture);
+  SpriteSheet(const SheetLayout &layout, const TextureHandle &texture);
 
   void drawIndex(
       Frame &f, const sf::Vector2f &dims, const int index) const;
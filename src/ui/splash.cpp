@@ -27,7 +27,9 @@ void SplashScreen::constructApp(const AppResources &resources) {
       settings,
       resources,
       references.uptime,
-      references.window,
+      references.tickAlpha,
+      references.tickStep,
+      references.target,
       references.profiler);
   animBegin = references.uptime;
   control = mkApp(initializedReferences.get());
@@ -39,9 +41,7 @@ SplashScreen::SplashScreen(
     std::function<std::unique_ptr<Control>(const AppRefs &)> mkApp) :
     Control(references),
     mkApp(mkApp),
-    loader(
-        {FontID::Default},
-        {TextureID::MenuBackground}),
+    loader({TextureID::MenuBackground}),
     animBegin(references.uptime) {
   if (loader.getErrorStatus()) {
     appLog("Bootstrap loading errored, quitting application!", LogOrigin::App);
@@ -72,18 +72,22 @@ void SplashScreen::tick(const TimeDiff delta) {
 
 void SplashScreen::render(ui::Frame &f) {
   if (loader.getErrorStatus()) return;
+  loader.stream(f);
 
   if (!control) {
     f.drawSprite(*background, {}, {0, 0, 1600, 900});
-    if (!loader.getHolder()) {
-      f.drawText({800, 450}, "loading resources...",
-                 style.base.freeTextColor, style.splash.titleFormat,
-                 *defaultFont);
+    // The rest streams in behind the app; there's no need to wait for it.
+    if (loader.getProgress() < 1) {
       f.drawRect({800.0f - (style.splash.barWidth / 2.0f),
                   (450.0f + style.splash.barPaddingTop),
                   (loader.getProgress() * style.splash.barWidth),
                   style.splash.barHeight},
                  style.splash.barColor);
+    }
+    if (!loader.getHolder()) {
+      f.drawText({800, 450}, "loading resources...",
+                 style.base.freeTextColor, style.splash.titleFormat,
+                 *defaultFont);
     } else {
       f.withAlpha(
           linearTween(0.3, 1, sineAnim(float(references.uptime), 0.2)),
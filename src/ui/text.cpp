@@ -82,13 +82,20 @@ sf::Vector2f TextFrame::endRender() {
 
 sf::Vector2f TextFrame::drawBlock(const sf::Vector2f &pos,
                                   const std::string &string) {
-  sf::Text text;
-  text.setFont(font);
-  text.setCharacterSize((unsigned int) format.size);
-  text.setString(string);
+  const float outlineThickness =
+      format.outlineColor ? format.outlineThickness : 0;
+  return drawBlock(pos, parent.textCache.get(
+      string, font, (unsigned int) format.size, outlineThickness,
+      format.maxWidth));
+}
 
-  const auto bounds = text.getLocalBounds();
+sf::Vector2f TextFrame::drawBlock(const sf::Vector2f &pos,
+                                  const TextLayout &layout) {
+  const auto size = (unsigned int) format.size;
+  const auto &bounds = layout.bounds;
   const sf::Vector2f dims = {bounds.width, bounds.height};
+  // Lines beyond the first, from wrapping or line breaks.
+  const float extraHeight = float(layout.lines - 1) * layout.lineSpacing;
 
   sf::Vector2f drawPos =
       anchor - sf::Vector2f(alignValue(format.horizontal) * dims.x, 0)
@@ -97,19 +104,25 @@ sf::Vector2f TextFrame::drawBlock(const sf::Vector2f &pos,
     drawPos.y -= bounds.top + 0.5f * dims.y;
   } else {
     drawPos.y -= alignValue(format.vertical) * float(format.size);
+    if (format.vertical == VerticalAlign::Bottom) drawPos.y -= extraHeight;
     drawnDimensions.x =
         std::max(std::abs(drawOffset.x) + dims.x, drawnDimensions.x);
     drawnDimensions.y =
         std::max(std::abs(drawOffset.y) + dims.y, drawnDimensions.y);
   }
-  text.setPosition(drawPos);
 
-  text.setFillColor(parent.alphaScaleColor(color));
-  if (format.outlineColor) {
-    text.setOutlineColor(parent.alphaScaleColor(format.outlineColor.get()));
-    text.setOutlineThickness(format.outlineThickness);
+  optional<sf::Color> outlineColor;
+  if (format.outlineColor)
+    outlineColor = parent.alphaScaleColor(format.outlineColor.get());
+  parent.batchText(layout, drawPos, font.getTexture(size),
+                   parent.alphaScaleColor(color), outlineColor);
+
+  // Text printed after a multi-line block continues from its last line.
+  if (layout.lines > 1) {
+    if (format.vertical == VerticalAlign::Top) drawOffset.y += extraHeight;
+    if (format.vertical == VerticalAlign::Bottom) drawOffset.y -= extraHeight;
+    return {layout.lastLineWidth, float(format.size)};
   }
-  parent.window.draw(text, parent.transformStack.top());
   return {bounds.width, float(format.size)};
 }
 
@@ -117,36 +130,6 @@ void TextFrame::print(const std::string &string) {
   assert(colorSet);
   parent.primCount++;
 
-  sf::Text text;
-  text.setFont(font);
-  text.setCharacterSize((unsigned int) format.size);
-  text.setString(string);
-
-//   TODO: word wrapping
-//  const float maxWidth = format.maxDimensions.x;
-//  std::string brokenString(string);
-//
-//  if (maxWidth > 0) {
-//    int width = (int) text.getLocalBounds().width;
-//    if (width > format.maxDimensions.x) {
-//      size_t prev = std::string::npos;
-//      float check = (width / maxWidth) + (width / maxWidth) * maxWidth;
-//      size_t p;
-//      while ((p = brokenString.find_last_of(' ', prev)) != std::string::npos) {
-//        int charPos = (int) text.findCharacterPos(p).x;
-//        if (charPos - check < 0) {
-//          brokenString.insert(p, "\n");
-//          check -= maxWidth;
-//          lines++;
-//          if (check < maxWidth) break;
-//        }
-//        prev = p - 1;
-//      }
-//      text.setString(brokenString);
-//    }
-//  }
-//  yOffset += text.getLocalBounds().height; // or something
-
   const auto dims = drawBlock(anchor, string);
   if (format.horizontal == HorizontalAlign::Left)
     drawOffset.x += dims.x;
@@ -154,6 +137,17 @@ void TextFrame::print(const std::string &string) {
     drawOffset.x -= dims.x;
 }
 
+void TextFrame::printLayout(const TextLayout &layout) {
+  assert(colorSet);
+  parent.primCount++;
+
+  const auto dims = drawBlock(anchor, layout);
+  if (format.horizontal == HorizontalAlign::Left)
+    drawOffset.x += dims.x;
+  if (format.horizontal == HorizontalAlign::Right)
+    drawOffset.x -= dims.x;
+}
+
 void TextFrame::setColor(const unsigned char r,
                          const unsigned char g,
                          const unsigned char b) {
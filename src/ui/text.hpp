@@ -22,15 +22,15 @@
 #include <SFML/Graphics.hpp>
 #include "util/printer.hpp"
 #include "resources.hpp"
+#include "textcache.hpp"
 
 namespace ui {
 
 /**
  * TODO
  * This will necessarily be updated in the future when we need:
- * 1) Word wrapping.
- * 2) Horizontal centering of multi-colored text.
- * 3) Vertical centering of multi-lined text.
+ * 1) Horizontal centering of multi-colored text.
+ * 2) Vertical centering of multi-lined text.
  *
  * The API should remain virtually unchanged though, so this is a
  * low-priority issue.
@@ -61,7 +61,7 @@ struct TextFormat {
                const float outlineThickness = 2);
 
   int size;
-  float maxWidth; // values of 0 mean there is no limit
+  float maxWidth; // words wrap past this; values of 0 mean there is no limit
   HorizontalAlign horizontal;
   VerticalAlign vertical;
 
@@ -96,6 +96,8 @@ class TextFrame: public Printer {
 
   sf::Vector2f drawBlock(const sf::Vector2f &pos,
                          const std::string &string);
+  sf::Vector2f drawBlock(const sf::Vector2f &pos,
+                         const TextLayout &layout);
   sf::Vector2f endRender();
 
  public:
@@ -108,6 +110,10 @@ class TextFrame: public Printer {
                 const unsigned char b) override final;
   void setColor(const sf::Color &color);
   void breakLine() override final;
+
+  // Print text laid out ahead of time, with TextCache::layout in this
+  // frame's font and size; it's not wrapped.
+  void printLayout(const TextLayout &layout);
 };
 
 }
@@ -0,0 +1,267 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <tuple>
+#include "textcache.hpp"
+
+namespace ui {
+
+namespace {
+
+// Append a glyph's quad, as sf::Text does it.
+void appendGlyph(std::vector<sf::Vertex> &vertices, const sf::Vector2f &pos,
+                 const sf::Glyph &glyph, const float outlineThickness) {
+  static constexpr float padding = 1;
+
+  const float left = glyph.bounds.left - padding - outlineThickness,
+      top = glyph.bounds.top - padding - outlineThickness,
+      right = glyph.bounds.left + glyph.bounds.width + padding
+          - outlineThickness,
+      bottom = glyph.bounds.top + glyph.bounds.height + padding
+          - outlineThickness;
+
+  const float u1 = float(glyph.textureRect.left) - padding,
+      v1 = float(glyph.textureRect.top) - padding,
+      u2 = float(glyph.textureRect.left + glyph.textureRect.width) + padding,
+      v2 = float(glyph.textureRect.top + glyph.textureRect.height) + padding;
+
+  const sf::Vertex topLeft(pos + sf::Vector2f(left, top), {u1, v1}),
+      topRight(pos + sf::Vector2f(right, top), {u2, v1}),
+      bottomLeft(pos + sf::Vector2f(left, bottom), {u1, v2}),
+      bottomRight(pos + sf::Vector2f(right, bottom), {u2, v2});
+  for (const auto &vertex : {topLeft, topRight, bottomLeft,
+                             bottomLeft, topRight, bottomRight}) {
+    vertices.push_back(vertex);
+  }
+}
+
+float measureWord(const std::string &word, const sf::Font &font,
+                  const unsigned int size) {
+  float width = 0;
+  sf::Uint32 prev = 0;
+  for (const char c : word) {
+    const sf::Uint32 current = static_cast<unsigned char>(c);
+    width += font.getKerning(prev, current, size)
+        + font.getGlyph(current, size, false).advance;
+    prev = current;
+  }
+  return width;
+}
+
+}
+
+/**
+ * TextLayout.
+ */
+
+TextLayout::TextLayout() :
+    lines(1),
+    lineSpacing(0),
+    lastLineWidth(0) { }
+
+/**
+ * TextLayoutKey.
+ */
+
+TextLayoutKey::TextLayoutKey(const std::string &string, const sf::Font &font,
+                             const unsigned int size,
+                             const float outlineThickness,
+                             const float maxWidth) :
+    string(string),
+    font(&font),
+    size(size),
+    outlineThickness(outlineThickness),
+    maxWidth(maxWidth) { }
+
+bool TextLayoutKey::operator<(const TextLayoutKey &x) const {
+  return std::tie(font, size, outlineThickness, maxWidth, string)
+      < std::tie(x.font, x.size, x.outlineThickness, x.maxWidth, x.string);
+}
+
+/**
+ * TextCacheStats.
+ */
+
+TextCacheStats::TextCacheStats() :
+    hits(0),
+    misses(0),
+    evictions(0),
+    entries(0) { }
+
+std::string TextCacheStats::print() const {
+  return std::to_string(hits) + " hits, "
+      + std::to_string(misses) + " misses, "
+      + std::to_string(evictions) + " evictions, "
+      + std::to_string(entries) + " entries";
+}
+
+/**
+ * TextCache.
+ */
+
+TextCache::TextCache(const size_t entryLimit) :
+    entryLimit(entryLimit) { }
+
+const TextLayout &TextCache::get(const std::string &string,
+                                 const sf::Font &font,
+                                 const unsigned int size,
+                                 const float outlineThickness,
+                                 const float maxWidth) {
+  const TextLayoutKey key(string, font, size, outlineThickness, maxWidth);
+
+  const auto found = index.find(key);
+  if (found != index.end()) {
+    stats.hits++;
+    entries.splice(entries.begin(), entries, found->second);
+    return found->second->second;
+  }
+
+  stats.misses++;
+  entries.emplace_front(
+      key, layout(maxWidth > 0 ? wrap(string, font, size, maxWidth) : string,
+                  font, size, outlineThickness));
+  index.emplace(key, entries.begin());
+
+  while (entries.size() > entryLimit) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+    stats.evictions++;
+  }
+  stats.entries = entries.size();
+  return entries.front().second;
+}
+
+void TextCache::clear() {
+  index.clear();
+  entries.clear();
+  stats.entries = 0;
+}
+
+const TextCacheStats &TextCache::getStats() const {
+  return stats;
+}
+
+TextLayout TextCache::layout(const std::string &string, const sf::Font &font,
+                             const unsigned int size,
+                             const float outlineThickness) {
+  TextLayout layout;
+  layout.lineSpacing = font.getLineSpacing(size);
+  const float whitespace = font.getGlyph(L' ', size, false).advance;
+
+  // The same walk as sf::Text's geometry update.
+  float x = 0, y = float(size);
+  float minX = float(size), minY = float(size), maxX = 0, maxY = 0;
+  sf::Uint32 prev = 0;
+
+  for (const char c : string) {
+    const sf::Uint32 current = static_cast<unsigned char>(c);
+    x += font.getKerning(prev, current, size);
+    prev = current;
+
+    if (current == ' ' or current == '\t' or current == '\n') {
+      minX = std::min(minX, x);
+      minY = std::min(minY, y);
+      switch (current) {
+        case ' ':
+          x += whitespace;
+          break;
+        case '\t':
+          x += whitespace * 4;
+          break;
+        case '\n':
+          y += layout.lineSpacing;
+          x = 0;
+          layout.lines++;
+          break;
+      }
+      maxX = std::max(maxX, x);
+      maxY = std::max(maxY, y);
+      continue;
+    }
+
+    if (outlineThickness != 0) {
+      const sf::Glyph &glyph =
+          font.getGlyph(current, size, false, outlineThickness);
+      appendGlyph(layout.outline, {x, y}, glyph, outlineThickness);
+      minX = std::min(minX, x + glyph.bounds.left - outlineThickness);
+      maxX = std::max(maxX, x + glyph.bounds.left + glyph.bounds.width
+          - outlineThickness);
+      minY = std::min(minY, y + glyph.bounds.top - outlineThickness);
+      maxY = std::max(maxY, y + glyph.bounds.top + glyph.bounds.height
+          - outlineThickness);
+    }
+
+    const sf::Glyph &glyph = font.getGlyph(current, size, false);
+    appendGlyph(layout.fill, {x, y}, glyph, 0);
+    if (outlineThickness == 0) {
+      minX = std::min(minX, x + glyph.bounds.left);
+      maxX = std::max(maxX, x + glyph.bounds.left + glyph.bounds.width);
+      minY = std::min(minY, y + glyph.bounds.top);
+      maxY = std::max(maxY, y + glyph.bounds.top + glyph.bounds.height);
+    }
+
+    x += glyph.advance;
+  }
+
+  layout.lastLineWidth = x;
+  if (!string.empty()) layout.bounds = {minX, minY, maxX - minX, maxY - minY};
+  return layout;
+}
+
+std::string TextCache::wrap(const std::string &string, const sf::Font &font,
+                            const unsigned int size, const float maxWidth) {
+  const float whitespace = font.getGlyph(L' ', size, false).advance;
+  std::string wrapped;
+  wrapped.reserve(string.size());
+
+  size_t lineStart = 0;
+  while (lineStart <= string.size()) {
+    const size_t lineEnd = std::min(string.find('\n', lineStart),
+                                    string.size());
+    float width = 0;
+    bool firstWord = true;
+
+    size_t wordStart = lineStart;
+    while (wordStart <= lineEnd) {
+      const size_t wordEnd = std::min(string.find(' ', wordStart), lineEnd);
+      const std::string word = string.substr(wordStart, wordEnd - wordStart);
+      const float wordWidth = measureWord(word, font, size);
+
+      if (firstWord) {
+        firstWord = false;
+      } else if (width > 0 and width + whitespace + wordWidth > maxWidth) {
+        wrapped += '\n';
+        width = 0;
+      } else {
+        wrapped += ' ';
+        width += whitespace;
+      }
+      wrapped += word;
+      width += wordWidth;
+
+      wordStart = wordEnd + 1;
+    }
+
+    if (lineEnd < string.size()) wrapped += '\n';
+    lineStart = lineEnd + 1;
+  }
+
+  return wrapped;
+}
+
+}
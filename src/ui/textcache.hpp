@@ -0,0 +1,109 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Cache of laid-out text, so strings drawn every frame aren't shaped anew.
+ */
+#pragma once
+#include <list>
+#include <map>
+#include <SFML/Graphics.hpp>
+
+namespace ui {
+
+/**
+ * A string laid out in a font as glyph quads (in triangles), ready to go into
+ * a Frame's batch. Positions are relative to the text's origin, as in
+ * sf::Text; texture coordinates are pixels in the font's texture for the
+ * character size. Vertex colors are left white, for the drawer to tint.
+ */
+struct TextLayout {
+  TextLayout();
+
+  std::vector<sf::Vertex> fill, outline;
+  sf::FloatRect bounds; // as sf::Text::getLocalBounds
+  size_t lines;
+  float lineSpacing, lastLineWidth;
+};
+
+/**
+ * Everything a TextLayout depends on.
+ */
+struct TextLayoutKey {
+  TextLayoutKey(const std::string &string, const sf::Font &font,
+                const unsigned int size, const float outlineThickness,
+                const float maxWidth);
+
+  std::string string;
+  const sf::Font *font;
+  unsigned int size;
+  float outlineThickness, maxWidth;
+
+  bool operator<(const TextLayoutKey &x) const;
+};
+
+/**
+ * Hit / miss counters of a TextCache.
+ */
+struct TextCacheStats {
+  TextCacheStats();
+
+  size_t hits, misses, evictions, entries;
+
+  std::string print() const;
+};
+
+/**
+ * LRU cache of TextLayouts, with a limit on the number of entries. Fonts are
+ * keyed by address, so they must outlive the cache (AppResources' fonts do).
+ *
+ * Only for use from the thread that renders, since laying out text can add
+ * glyphs to a font's texture.
+ */
+class TextCache {
+ private:
+  using Entry = std::pair<TextLayoutKey, TextLayout>;
+
+  size_t entryLimit;
+  std::list<Entry> entries; // Most recently used first.
+  std::map<TextLayoutKey, std::list<Entry>::iterator> index;
+  TextCacheStats stats;
+
+ public:
+  TextCache(const size_t entryLimit = 1024);
+  TextCache(const TextCache &) = delete;
+
+  // Look up a layout, laying it out on a miss. The reference is good until
+  // the next call.
+  const TextLayout &get(const std::string &string, const sf::Font &font,
+                        const unsigned int size,
+                        const float outlineThickness = 0,
+                        const float maxWidth = 0);
+
+  void clear();
+  const TextCacheStats &getStats() const;
+
+  // Uncached layout, and greedy word wrapping at spaces (0 means no limit).
+  static TextLayout layout(const std::string &string, const sf::Font &font,
+                           const unsigned int size,
+                           const float outlineThickness = 0);
+  static std::string wrap(const std::string &string, const sf::Font &font,
+                          const unsigned int size, const float maxWidth);
+
+};
+
+}
@@ -116,6 +116,10 @@ bool Button::handle(const sf::Event &event) {
   return false;
 }
 
+bool Button::animating() const {
+  return active and float(heat) != (isHot ? 1.0f : 0.0f);
+}
+
 void Button::signalClear() {
   clickSignal = false;
 }
@@ -70,6 +70,7 @@ class Button: public Control {
   bool handle(const sf::Event &event) override;
   void signalClear() override;
   void reset() override;
+  bool animating() const override;
 
   // User API.
   optional<std::string> description;
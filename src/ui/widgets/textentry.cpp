@@ -220,6 +220,11 @@ void TextEntry::reset() {
   hot = false;
 }
 
+bool TextEntry::animating() const {
+  // Held keys repeat from tick.
+  return float(heat) != (hot ? 1.0f : 0.0f) or bool(pressedKeyboardEvent);
+}
+
 void TextEntry::focus() {
   focused = true;
   if (persistent) cursor = (int) contents.size();
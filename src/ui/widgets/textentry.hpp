@@ -86,6 +86,7 @@ class TextEntry: public Control {
   void signalRead() override final;
   void signalClear() override final;
   void reset() override final;
+  bool animating() const override final;
 
   // User API.
   std::string contents;
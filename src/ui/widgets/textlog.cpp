@@ -16,42 +16,26 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "textlog.hpp"
-#include <boost/iterator_adaptors.hpp>
 
 namespace ui {
 
 namespace detail {
 
 /**
- * PrintAction.
+ * LogLine.
  */
 
-PrintAction::PrintAction(const PrintAction::Type type) :
-    type(type) { }
-
-void PrintAction::print(Printer &p) const {
-  switch (type) {
-    case Type::Color: {
-      p.setColor(color->r, color->g, color->b);
-      break;
-    }
-    case Type::Print: {
-      p.print(string.get());
-      break;
-    }
-  }
+void LogLine::reset(const Time time) {
+  this->time = time;
+  used = 0;
+  laidOut = false;
 }
 
-PrintAction PrintAction::Color(const sf::Color &color) {
-  PrintAction action(Type::Color);
-  action.color = color;
-  return action;
-}
-
-PrintAction PrintAction::Print(const std::string &string) {
-  PrintAction action(Type::Print);
-  action.string = string;
-  return action;
+void LogLine::layOut(const sf::Font &font, const unsigned int size) {
+  if (laidOut) return;
+  for (size_t i = 0; i < used; ++i)
+    runs[i].layout = TextCache::layout(runs[i].string, font, size);
+  laidOut = true;
 }
 
 }
@@ -66,24 +50,45 @@ TextLog::Style::Style(
     const float maxHeightCollapsed,
     const Time maxLifetimeCollapsed,
     const float fadeStart,
-    const int fontSize) :
+    const int fontSize,
+    const size_t scrollback) :
     maxWidth(maxWidth),
     maxHeight(maxHeight),
     maxHeightCollapsed(maxHeightCollapsed),
     maxLifetimeCollapsed(maxLifetimeCollapsed),
     fadeStart(fadeStart),
-    fontSize(fontSize) { }
+    fontSize(fontSize),
+    scrollback(scrollback) { }
 
 void TextLog::startNewLine() {
-  lines.emplace_back(references.uptime, std::vector<detail::PrintAction>());
+  lines.push().reset(references.uptime);
+  if (scroll > 0) scroll = std::min(scroll + 1, lines.size() - 1);
   startingNewLine = false;
 }
 
+detail::LogRun &TextLog::currentRun() {
+  if (startingNewLine) startNewLine();
+  auto &line = lines.back();
+  line.laidOut = false;
+
+  if (line.used == 0 or line.runs[line.used - 1].color != color) {
+    if (line.used == line.runs.size()) line.runs.emplace_back();
+    auto &run = line.runs[line.used++];
+    run.color = color;
+    run.string.clear();
+    return run;
+  }
+  return line.runs[line.used - 1];
+}
+
 TextLog::TextLog(const AppRefs &references, const Style &style,
                  const sf::Vector2f &pos) :
     Control(references),
     style(style), pos(pos),
     startingNewLine(true),
+    color(sf::Color::White),
+    lines(style.scrollback),
+    scroll(0),
     textFormat(style.fontSize, 0, ui::HorizontalAlign::Left, ui::VerticalAlign::Bottom),
     collapsed(false) { }
 
@@ -91,53 +96,61 @@ void TextLog::tick(TimeDiff) { }
 
 void TextLog::render(Frame &f) {
   const float maxHeight = collapsed ? style.maxHeightCollapsed : style.maxHeight;
+  const size_t skipped = collapsed ? 0 : scroll;
 
   f.drawText(pos, [&](TextFrame &tf) {
-    for (auto iter = lines.rbegin();
-         iter < lines.rend();
-         iter++) {
-      const auto &pair = *iter;
-      const Time age = references.timeSince(pair.first);
+    // Newest first, stopping at the first line that wouldn't be seen.
+    for (size_t i = lines.size() - std::min(skipped, lines.size()); i-- > 0;) {
+      auto &line = lines[i];
+      const Time age = references.timeSince(line.time);
 
+      double alpha = 1;
       if (collapsed) {
-        if (age < style.maxLifetimeCollapsed) {
-          const double alpha =
-              (style.fadeStart == 0) ? 1 :
-              clamp(0.0, 1.0, 1 - ((age - style.fadeStart)
-                  / (style.maxLifetimeCollapsed - style.fadeStart)));
-          f.withAlpha(float(alpha), [&]() {
-            for (auto &action : pair.second) action.print(tf);
-          });
-          tf.breakLine();
-        } else {
-          break;
-        }
-      } else {
-        for (auto &action : pair.second) action.print(tf);
-        tf.breakLine();
+        if (age >= style.maxLifetimeCollapsed) break;
+        if (style.fadeStart != 0)
+          alpha = clamp(0.0, 1.0, 1 - ((age - style.fadeStart)
+              / (style.maxLifetimeCollapsed - style.fadeStart)));
       }
 
+      line.layOut(resources.defaultFont, (unsigned int) style.fontSize);
+      f.withAlpha(float(alpha), [&]() {
+        for (size_t j = 0; j < line.used; ++j) {
+          tf.setColor(line.runs[j].color);
+          tf.printLayout(line.runs[j].layout);
+        }
+      });
+      tf.breakLine();
+
       if (-tf.drawOffset.y > maxHeight && maxHeight != 0) break;
     }
   }, textFormat, resources.defaultFont);
 }
 
 bool TextLog::handle(const sf::Event &event) {
-  return false;
+  // The vertical wheel scrolls the expanded log when it's over it, and
+  // goes no further; anywhere else, it's left for other controls.
+  if (event.type != sf::Event::MouseWheelScrolled
+      or event.mouseWheelScroll.wheel != sf::Mouse::VerticalWheel
+      or collapsed or lines.empty()) return false;
+
+  const float height = style.maxHeight != 0 ? style.maxHeight : pos.y;
+  const sf::FloatRect area(pos.x, pos.y - height, style.maxWidth, height);
+  if (!area.contains(float(event.mouseWheelScroll.x),
+                     float(event.mouseWheelScroll.y))) return false;
+
+  const int lineDelta = event.mouseWheelScroll.delta > 0 ? 1 : -1;
+  scroll = size_t(clamp(0, int(lines.size()) - 1, int(scroll) + lineDelta));
+  return true;
 }
 
 void TextLog::print(const std::string &str) {
-  if (startingNewLine) startNewLine();
-  lines.rbegin()->second.push_back(
-      detail::PrintAction::Print(str));
+  currentRun().string += str;
 }
 
 void TextLog::setColor(const unsigned char r,
                        const unsigned char g,
                        const unsigned char b) {
-  if (startingNewLine) startNewLine();
-  lines.rbegin()->second.push_back(
-      detail::PrintAction::Color(sf::Color(r, b, g)));
+  color = sf::Color(r, g, b);
 }
 
 void TextLog::breakLine() {
@@ -146,6 +159,7 @@ void TextLog::breakLine() {
 
 void TextLog::clear() {
   lines.clear();
+  scroll = 0;
 }
 
 }
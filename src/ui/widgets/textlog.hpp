@@ -27,27 +27,27 @@ namespace ui {
 namespace detail {
 
 /**
- * A single action effected by a PrinterProcess.
- * Media through which the Printer invocations are stored in the TextLog.
+ * Some text printed in one color, and its layout once it's been drawn.
  */
-struct PrintAction {
- private:
-  enum class Type {
-    Color, Print
-  } type;
-
-  PrintAction(const Type type);
- public:
-  optional<sf::Color> color;
-  optional<std::string> string;
-
-  void print(Printer &) const;
-
-  static PrintAction Color(const sf::Color &color);
-  static PrintAction Print(const std::string &string);
+struct LogRun {
+  sf::Color color;
+  std::string string;
+  TextLayout layout;
 };
 
-using LogLine = std::vector<PrintAction>;
+/**
+ * A line of the log. Its runs are laid out the first time it's drawn after
+ * it changes, which for every line but the last is once.
+ */
+struct LogLine {
+  Time time;
+  std::vector<LogRun> runs; // only the first `used` are part of the line
+  size_t used;
+  bool laidOut;
+
+  void reset(const Time time);
+  void layOut(const sf::Font &font, const unsigned int size);
+};
 
 }
 
@@ -57,6 +57,7 @@ class TextLog: public Control, public Printer {
     float maxWidth, maxHeight, maxHeightCollapsed;
     Time maxLifetimeCollapsed, fadeStart;
     int fontSize;
+    size_t scrollback; // lines kept
 
     Style() = delete;
     Style(const float maxWidth,
@@ -64,15 +65,21 @@ class TextLog: public Control, public Printer {
           const float maxHeightCollapsed,
           const Time maxLifetimeCollapsed,
           const float fadeStart,
-          const int fontSize);
+          const int fontSize,
+          const size_t scrollback);
   } style;
 
  private:
   sf::Vector2f pos;
 
+  // Lines are kept in a ring, so the log's memory doesn't grow, and slots
+  // (with their strings and layouts) are reused as old lines fall off.
   void startNewLine();
+  detail::LogRun &currentRun();
   bool startingNewLine;
-  std::vector<std::pair<Time, detail::LogLine>> lines;
+  sf::Color color;
+  RingBuffer<detail::LogLine> lines;
+  size_t scroll; // lines scrolled back from the newest, while expanded
 
   TextFormat textFormat; // derived from style
 
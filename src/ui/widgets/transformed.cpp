@@ -20,28 +20,36 @@
 
 namespace ui {
 
-TransformedBase::TransformedBase(Control &ctrl, const sf::Transform &transform) :
-    Control(ctrl.references), ctrl(ctrl), transform(transform) {}
+TransformedBase::TransformedBase(Control &ctrl, const sf::Transform &transform,
+                                 const bool retained) :
+    Control(ctrl.references), ctrl(ctrl), transform(transform),
+    retained(retained) {}
 
 void TransformedBase::poll() {
   ctrl.poll();
 }
 
 void TransformedBase::tick(const TimeDiff delta) {
+  // Before and after: the tick that ends an animation changes the render too.
+  const bool wasAnimating = ctrl.animating();
   ctrl.tick(delta);
+  if (wasAnimating or ctrl.animating()) cache.invalidate();
 }
 
 void TransformedBase::render(Frame &f) {
   f.withTransform(transform, [&]() {
-    ctrl.render(f);
+    if (retained) f.drawCached(cache, [&]() { ctrl.render(f); });
+    else ctrl.render(f);
   });
 }
 
 bool TransformedBase::handle(const sf::Event &event) {
+  cache.invalidate();
   return ctrl.handle(transformEvent(inverseTransform, event));
 }
 
 void TransformedBase::reset() {
+  cache.invalidate();
   ctrl.reset();
 }
 
@@ -53,6 +61,10 @@ void TransformedBase::signalClear() {
   ctrl.signalClear();
 }
 
+bool TransformedBase::animating() const {
+  return ctrl.animating();
+}
+
 const sf::Transform TransformedBase::getTransform() const {
   return transform;
 }
@@ -62,4 +74,12 @@ void TransformedBase::setTransform(const sf::Transform &newTransform) {
   inverseTransform = transform.getInverse();
 }
 
+void TransformedBase::invalidate() {
+  cache.invalidate();
+}
+
+const RenderCache &TransformedBase::getCache() const {
+  return cache;
+}
+
 }
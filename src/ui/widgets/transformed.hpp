@@ -20,11 +20,17 @@
  */
 #pragma once
 #include "ui/control.hpp"
+#include "ui/rendercache.hpp"
 
 namespace ui {
 
 /**
  * Template-erased base class used by Transformed.
+ *
+ * A retained TransformedBase keeps its Control's render in a RenderCache,
+ * and redraws it only after events, resets, resizes, explicit
+ * invalidation, or while the Control is animating. The transform applies
+ * to the cached render, so moving it around costs nothing.
  */
 class TransformedBase : public Control {
  private:
@@ -34,8 +40,13 @@ class TransformedBase : public Control {
   sf::Transform transform;
   sf::Transform inverseTransform;
 
+  // Retained rendering.
+  const bool retained;
+  RenderCache cache;
+
  public:
-  TransformedBase(Control &ctrl, const sf::Transform &transform);
+  TransformedBase(Control &ctrl, const sf::Transform &transform,
+                  const bool retained = false);
 
   // Control impl.
   virtual void poll() override;
@@ -45,11 +56,16 @@ class TransformedBase : public Control {
   virtual void reset() override;
   virtual void signalRead() override;
   virtual void signalClear() override;
+  virtual bool animating() const override;
 
   // Transformation.
   const sf::Transform getTransform() const;
   void setTransform(const sf::Transform &newTransform);
 
+  // Retained rendering, for changes not driven by events or ticks.
+  void invalidate();
+  const RenderCache &getCache() const;
+
 };
 
 /**
@@ -62,10 +78,11 @@ class Transformed : public Control {
   std::unique_ptr<Ctrl> ctrlPtr;
 
  public:
-  Transformed(std::unique_ptr<Ctrl> &&ctrl, const sf::Transform &transform) :
+  Transformed(std::unique_ptr<Ctrl> &&ctrl, const sf::Transform &transform,
+              const bool retained = false) :
       Control(ctrl->references),
       ctrlPtr(std::move(ctrl)),
-      base(*ctrlPtr, transform),
+      base(*ctrlPtr, transform, retained),
       ctrl(*ctrlPtr) {
     areChildren({&base});
   }
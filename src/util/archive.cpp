@@ -16,10 +16,35 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "archive.hpp"
-#include <unistd.h>
+#include <zlib.h>
 #include "util/printer.hpp"
 #include "methods.hpp"
 
+namespace {
+
+// Zip structures are little-endian, and not necessarily aligned.
+uint16_t read16(const char *p) {
+  const auto *b = reinterpret_cast<const unsigned char *>(p);
+  return uint16_t(b[0] | (b[1] << 8));
+}
+
+uint32_t read32(const char *p) {
+  const auto *b = reinterpret_cast<const unsigned char *>(p);
+  return uint32_t(b[0]) | (uint32_t(b[1]) << 8)
+      | (uint32_t(b[2]) << 16) | (uint32_t(b[3]) << 24);
+}
+
+const uint32_t localHeaderSig = 0x04034b50,
+    centralHeaderSig = 0x02014b50,
+    endOfDirectorySig = 0x06054b50;
+const size_t localHeaderSize = 30,
+    centralHeaderSize = 46,
+    endOfDirectorySize = 22;
+
+const uint16_t methodStored = 0, methodDeflated = 8;
+
+}
+
 /**
  * Directory.
  */
@@ -71,13 +96,77 @@ optional<Directory> Directory::open(const fs::path &path) {
  * Archive.
  */
 
+bool Archive::readCentralDirectory() {
+  const char *data = file.data();
+  const size_t size = file.size();
+  if (size < endOfDirectorySize) return false;
+
+  // The end of central directory record is at the very end of the file,
+  // followed only by a comment of up to 64k.
+  const size_t searchLimit = std::min(size, endOfDirectorySize + 0xffff);
+  const char *eocd = nullptr;
+  for (size_t back = endOfDirectorySize; back <= searchLimit; ++back) {
+    const char *p = data + size - back;
+    if (read32(p) == endOfDirectorySig) {
+      eocd = p;
+      break;
+    }
+  }
+  if (!eocd) return false;
+
+  const size_t entries = read16(eocd + 10),
+      directorySize = read32(eocd + 12),
+      directoryOffset = read32(eocd + 16);
+  if (directoryOffset + directorySize > size) return false;
+
+  const char *p = data + directoryOffset,
+      *end = data + directoryOffset + directorySize;
+  for (size_t i = 0; i < entries; ++i) {
+    if (p + centralHeaderSize > end or read32(p) != centralHeaderSig)
+      return false;
+
+    const size_t nameLength = read16(p + 28),
+        extraLength = read16(p + 30),
+        commentLength = read16(p + 32);
+    if (p + centralHeaderSize + nameLength > end) return false;
+
+    Member member;
+    member.method = read16(p + 10);
+    member.crc = read32(p + 16);
+    member.compressedSize = read32(p + 20);
+    member.size = read32(p + 24);
+    member.headerOffset = read32(p + 42);
+    members.emplace(std::string(p + centralHeaderSize, nameLength), member);
+
+    p += centralHeaderSize + nameLength + extraLength + commentLength;
+  }
+
+  return true;
+}
+
+optional<size_t> Archive::findData(const Member &member) const {
+  // The local header repeats the name, and may have a different extra field.
+  if (member.headerOffset + localHeaderSize > file.size()) return {};
+  const char *header = file.data() + member.headerOffset;
+  if (read32(header) != localHeaderSig) return {};
+  const size_t dataOffset = member.headerOffset + localHeaderSize
+      + read16(header + 26) + read16(header + 28);
+  if (dataOffset + member.compressedSize > file.size()) return {};
+  return dataOffset;
+}
+
 Archive::Archive(const fs::path &archivePath) :
     done(false),
+    opened(false),
     archivePath(archivePath) {}
 
 void Archive::load() {
   const auto filepath = this->archivePath.string();
-  appLog("Unzipping archive: " + filepath, LogOrigin::App);
+  appLog("Opening archive: " + filepath, LogOrigin::App);
+
+  file.close();
+  members.clear();
+  opened = false;
 
   if (!fs::exists(this->archivePath)) {
     appLog("Archive filepath does not exist!", LogOrigin::Error);
@@ -91,31 +180,106 @@ void Archive::load() {
     return;
   }
 
-  const char* tmpDir = std::getenv("TMPDIR");
-  if (!tmpDir) {
-      tmpDir = ".";
+  if (!file.open(this->archivePath)) {
+    appLog("Could not read archive file!", LogOrigin::Error);
+  } else if (!readCentralDirectory()) {
+    appLog("Archive file is not a readable zip archive!", LogOrigin::Error);
+    members.clear();
+    file.close();
+  } else {
+    opened = true;
   }
 
-  fs::path workingDir(std::string(tmpDir) + "/.unzip-tmp/" + std::to_string(getProcessID()) + "/"
-                        + this->archivePath.filename().string());
-  fs::remove_all(workingDir);
-  fs::create_directories(workingDir);
-
-  // Invoke 7zip through the shell. I'm sorry.
-  chdir(workingDir.string().c_str());
-  runSystemQuiet("7z x " + inQuotes(archivePath.string()));
-  chdir("../../../");
-  // appLog(workingDir.string());
-
-  if (const auto opened = Directory::open(workingDir))
-    this->result.emplace(*opened);
+  this->done = true;
 }
 
 bool Archive::isDone() const {
   return done;
 }
 
-Directory const *Archive::getResult() const {
-  return result.get_ptr();
+bool Archive::isOpen() const {
+  return opened;
+}
+
+std::string Archive::getName() const {
+  return getFilename(archivePath);
+}
+
+std::vector<std::string> Archive::getTopFiles() const {
+  std::vector<std::string> files;
+  for (const auto &member : members) {
+    if (member.first.find('/') == std::string::npos)
+      files.push_back(member.first);
+  }
+  return files;
 }
 
+bool Archive::hasFile(const std::string &filename) const {
+  return members.find(filename) != members.end();
+}
+
+uint32_t Archive::getChecksum() const {
+  return uint32_t(crc32(0, reinterpret_cast<const Bytef *>(file.data()),
+                        uInt(file.size())));
+}
+
+optional<std::string> Archive::readFile(const std::string &filename) const {
+  const auto iter = members.find(filename);
+  if (iter == members.end()) return {};
+  const Member &member = iter->second;
+
+  const auto dataOffset = findData(member);
+  if (!dataOffset) return {};
+  const char *compressed = file.data() + dataOffset.get();
+
+  std::string contents;
+  switch (member.method) {
+    case methodStored: {
+      if (member.compressedSize != member.size) return {};
+      contents.assign(compressed, member.size);
+      break;
+    }
+    case methodDeflated: {
+      contents.resize(member.size);
+      z_stream stream{};
+      // Negative window bits: raw deflate data, without a zlib header.
+      if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) return {};
+      stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed));
+      stream.avail_in = uInt(member.compressedSize);
+      stream.next_out = reinterpret_cast<Bytef *>(&contents[0]);
+      stream.avail_out = uInt(member.size);
+      const int status = inflate(&stream, Z_FINISH);
+      inflateEnd(&stream);
+      if (status != Z_STREAM_END or stream.total_out != member.size) return {};
+      break;
+    }
+    default: {
+      appLog("Archive member " + inQuotes(filename)
+                 + " uses an unsupported compression method!", LogOrigin::Error);
+      return {};
+    }
+  }
+
+  const auto crc = crc32(0, reinterpret_cast<const Bytef *>(contents.data()),
+                         uInt(contents.size()));
+  if (crc != member.crc) {
+    appLog("Archive member " + inQuotes(filename) + " is corrupt!",
+           LogOrigin::Error);
+    return {};
+  }
+
+  return contents;
+}
+
+const char *Archive::viewFile(const std::string &filename, size_t &size) const {
+  const auto iter = members.find(filename);
+  if (iter == members.end()) return nullptr;
+  const Member &member = iter->second;
+  if (member.method != methodStored or member.compressedSize != member.size)
+    return nullptr;
+
+  const auto dataOffset = findData(member);
+  if (!dataOffset) return nullptr;
+  size = member.size;
+  return file.data() + dataOffset.get();
+}
@@ -22,6 +22,7 @@
 #include "util/types.hpp"
 #include "util/threads.hpp"
 #include "util/filepath.hpp"
+#include "util/mappedfile.hpp"
 
 /**
  * Handle to the directory of an opened archive, whose contents we can access.
@@ -50,18 +51,37 @@ struct Directory {
 };
 
 /**
- * Handle to the (asynchronous) process of opening an archive.
- * Uses the 7z binary found in the system PATH to unzip.
+ * Handle to a zip archive, read in-process. Loading maps the file into memory
+ * and reads its central directory; members are then inflated straight into
+ * memory, one at a time, when they're asked for.
+ *
+ * Stored and deflated members are supported; zip64 and encryption are not.
  */
 class Archive {
  private:
+  // A member, as listed in the central directory.
+  struct Member {
+    size_t headerOffset; // Of the member's local header.
+    size_t compressedSize, size;
+    uint16_t method;
+    uint32_t crc;
+  };
+
+  MappedFile file;
 
   // Result state.
   bool done;
-  optional<Directory> result;
+  bool opened;
+  std::map<std::string, Member> members;
+
+  bool readCentralDirectory();
+  // Where a member's data starts in the file, checking it's in bounds.
+  optional<size_t> findData(const Member &member) const;
 
  public:
   Archive(const fs::path &archivePath);
+  Archive(const Archive &) = delete;
+  Archive &operator=(const Archive &) = delete;
 
   const fs::path archivePath;
 
@@ -69,8 +89,20 @@ class Archive {
   void load();
   bool isDone() const;
 
-  // When done, we present either a result or an error.
-  Directory const *getResult() const;
+  // When done, we present either an opened archive or an error.
+  bool isOpen() const;
+  std::string getName() const;
+  std::vector<std::string> getTopFiles() const;
+  bool hasFile(const std::string &filename) const;
+
+  // CRC-32 of the whole archive file, identifying its contents.
+  uint32_t getChecksum() const;
+
+  // Inflate a member into memory. Safe to call from several threads at once.
+  optional<std::string> readFile(const std::string &filename) const;
+  // Point straight into the mapped file at a member stored without
+  // compression; nullptr otherwise. Valid as long as the Archive is.
+  const char *viewFile(const std::string &filename, size_t &size) const;
 
 };
 
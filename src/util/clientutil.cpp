@@ -246,7 +246,8 @@ sf::Event transformEvent(const sf::Transform trans, const sf::Event event) {
   const bool mouseMoved(event.type == sf::Event::MouseMoved),
       mousePressed(event.type == sf::Event::MouseButtonPressed ||
       event.type == sf::Event::MouseButtonReleased),
-      mouseSomething(mouseMoved || mousePressed);
+      mouseScrolled(event.type == sf::Event::MouseWheelScrolled),
+      mouseSomething(mouseMoved || mousePressed || mouseScrolled);
 
   if (mouseSomething) {
     sf::Vector2f pos;
@@ -258,6 +259,10 @@ sf::Event transformEvent(const sf::Transform trans, const sf::Event event) {
       pos = trans.transformPoint(
           sf::Vector2f(event.mouseButton.x, event.mouseButton.y));
     }
+    if (mouseScrolled) {
+      pos = trans.transformPoint(
+          sf::Vector2f(event.mouseWheelScroll.x, event.mouseWheelScroll.y));
+    }
 
     sf::Event newEvent;
     newEvent.type = event.type;
@@ -275,6 +280,14 @@ sf::Event transformEvent(const sf::Transform trans, const sf::Event event) {
       newMouseButton.button = event.mouseButton.button;
       newEvent.mouseButton = newMouseButton;
     }
+    if (mouseScrolled) {
+      sf::Event::MouseWheelScrollEvent newMouseWheelScroll;
+      newMouseWheelScroll.wheel = event.mouseWheelScroll.wheel;
+      newMouseWheelScroll.delta = event.mouseWheelScroll.delta;
+      newMouseWheelScroll.x = (int) std::round(pos.x);
+      newMouseWheelScroll.y = (int) std::round(pos.y);
+      newEvent.mouseWheelScroll = newMouseWheelScroll;
+    }
 
     return newEvent;
   }
@@ -0,0 +1,96 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "mappedfile.hpp"
+#include <fstream>
+
+#if defined(__linux) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() :
+    fileData(nullptr),
+    fileSize(0),
+    mapped(false),
+    opened(false) {}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const fs::path &path) {
+  close();
+  const auto filepath = path.string();
+
+#if defined(__linux) || defined(__APPLE__)
+  const int fd = ::open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  const size_t size = size_t(info.st_size);
+  if (size > 0) {
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map != MAP_FAILED) {
+      fileData = static_cast<const char *>(map);
+      fileSize = size;
+      mapped = opened = true;
+    }
+  }
+  ::close(fd);
+  if (mapped) return true;
+#endif
+
+  // No mmap here (or it failed): read the whole thing instead.
+  std::ifstream file(filepath, std::ios::binary);
+  if (!file) return false;
+  buffer.assign(std::istreambuf_iterator<char>(file),
+                std::istreambuf_iterator<char>());
+  fileData = buffer.data();
+  fileSize = buffer.size();
+  opened = true;
+  return true;
+}
+
+void MappedFile::close() {
+#if defined(__linux) || defined(__APPLE__)
+  if (mapped) munmap(const_cast<char *>(fileData), fileSize);
+#endif
+  mapped = opened = false;
+  fileData = nullptr;
+  fileSize = 0;
+  buffer.clear();
+}
+
+bool MappedFile::isOpen() const {
+  return opened;
+}
+
+const char *MappedFile::data() const {
+  return fileData;
+}
+
+size_t MappedFile::size() const {
+  return fileSize;
+}
@@ -0,0 +1,51 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Read-only memory-mapped files.
+ */
+#pragma once
+#include <vector>
+#include "util/filepath.hpp"
+
+/**
+ * A whole file mapped read-only into memory. Where we can't map it (or
+ * mapping fails), the file is read into a buffer instead, so callers
+ * see the same thing either way.
+ */
+class MappedFile {
+ private:
+  const char *fileData;
+  size_t fileSize;
+  bool mapped, opened;
+  std::vector<char> buffer;
+
+ public:
+  MappedFile();
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  // Map a file, closing whatever was mapped before. False on failure.
+  bool open(const fs::path &path);
+  void close();
+
+  bool isOpen() const;
+  const char *data() const;
+  size_t size() const;
+
+};
@@ -0,0 +1,82 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include "profiling.hpp"
+
+namespace {
+
+thread_local ProfileSink *profileSink = nullptr;
+
+std::atomic<size_t> allocations(0);
+
+}
+
+std::string showProfileStage(const ProfileStage stage) {
+  switch (stage) {
+    case ProfileStage::Events:
+      return "events";
+    case ProfileStage::Poll:
+      return "poll";
+    case ProfileStage::Tick:
+      return "tick";
+    case ProfileStage::Subsystems:
+      return "subsystems";
+    case ProfileStage::Render:
+      return "render";
+    case ProfileStage::SkyRender:
+      return "skyrender";
+    case ProfileStage::UIRender:
+      return "uirender";
+    case ProfileStage::Display:
+      return "display";
+    default:
+      return "";
+  }
+}
+
+void setProfileSink(ProfileSink *sink) {
+  profileSink = sink;
+}
+
+ProfileSink *getProfileSink() {
+  return profileSink;
+}
+
+/**
+ * ProfileScope.
+ */
+
+ProfileScope::ProfileScope(const ProfileStage stage) :
+    sink(profileSink),
+    stage(stage),
+    start(sink ? std::chrono::steady_clock::now()
+               : std::chrono::steady_clock::time_point()) { }
+
+ProfileScope::~ProfileScope() {
+  if (!sink) return;
+  sink->record(stage, std::chrono::duration<TimeDiff>(
+      std::chrono::steady_clock::now() - start).count());
+}
+
+void countAllocation() {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t allocationCount() {
+  return allocations.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * Lightweight instrumentation: named stages timed by RAII scopes, and a
+ * global allocation counter.
+ */
+#pragma once
+#include <chrono>
+#include <string>
+#include "types.hpp"
+
+/**
+ * Stages of the client's frame, as broken down by the profiler.
+ */
+enum class ProfileStage {
+  Events, // handling window events
+  Poll, // Control::poll
+  Tick, // Control::tick, in total
+  Subsystems, // Arena subsystems ticking, part of Tick
+  Render, // Control::render, in total
+  SkyRender, // the game world, part of Render
+  UIRender, // the rest of Render, derived by the profiler
+  Display, // replaying the frame and waiting on the display
+  MAX
+};
+
+std::string showProfileStage(const ProfileStage stage);
+
+/**
+ * Receives stage timings from ProfileScopes.
+ */
+class ProfileSink {
+ public:
+  virtual ~ProfileSink() = default;
+  virtual void record(const ProfileStage stage, const TimeDiff time) = 0;
+
+};
+
+/**
+ * The sink ProfileScopes on this thread record into; nullptr by default,
+ * in which case scopes cost nothing but a branch.
+ */
+void setProfileSink(ProfileSink *sink);
+ProfileSink *getProfileSink();
+
+/**
+ * Times its own lifetime and records it as a stage, in the sink this
+ * thread had when it was constructed.
+ */
+class ProfileScope {
+ private:
+  ProfileSink *const sink;
+  const ProfileStage stage;
+  const std::chrono::steady_clock::time_point start;
+
+ public:
+  ProfileScope(const ProfileStage stage);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+};
+
+/**
+ * Heap allocations, as counted by whichever executable hooks operator new.
+ */
+void countAllocation();
+size_t allocationCount();
+
@@ -0,0 +1,244 @@
+/**
+ * solemnsky: the open-source multiplayer competitive 2D plane game
+ * Copyright (C) 2016  Chris Gadzinski
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include "threads.hpp"
+
+namespace {
+
+// The pool and worker index of the current thread, if it's a worker.
+thread_local const TaskPool *currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+}
+
+/**
+ * Task.
+ */
+
+Task::Task(std::function<void()> &&work, const TaskPriority priority) :
+    work(std::move(work)),
+    priority(priority),
+    waitingOn(0),
+    done(false) {}
+
+bool Task::isDone() const {
+  return done;
+}
+
+std::exception_ptr Task::getError() const {
+  return error;
+}
+
+/**
+ * TaskPool.
+ */
+
+bool TaskPool::onWorker(size_t &worker) const {
+  if (currentPool != this) return false;
+  worker = currentWorker;
+  return true;
+}
+
+void TaskPool::enqueue(const TaskHandle &task) {
+  size_t worker;
+  if (!onWorker(worker)) worker = nextQueue++ % queues.size();
+
+  {
+    WorkerQueue &queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks[size_t(task->priority)].push_back(task);
+  }
+  queued++;
+
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  wakeWorker.notify_one();
+}
+
+TaskHandle TaskPool::take(const bool isWorker, const size_t worker) {
+  if (queued == 0) return nullptr;
+
+  for (size_t priority = 0; priority < size_t(TaskPriority::MAX); ++priority) {
+    // Our own newest task, while it's still warm in cache...
+    if (isWorker) {
+      WorkerQueue &queue = *queues[worker];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      auto &tasks = queue.tasks[priority];
+      if (!tasks.empty()) {
+        const TaskHandle task = std::move(tasks.back());
+        tasks.pop_back();
+        queued--;
+        return task;
+      }
+    }
+
+    // ... or someone else's oldest.
+    for (size_t i = 1; i <= queues.size(); ++i) {
+      const size_t victim = (worker + i) % queues.size();
+      if (isWorker and victim == worker) continue;
+      WorkerQueue &queue = *queues[victim];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      auto &tasks = queue.tasks[priority];
+      if (!tasks.empty()) {
+        const TaskHandle task = std::move(tasks.front());
+        tasks.pop_front();
+        queued--;
+        return task;
+      }
+    }
+  }
+
+  return nullptr;
+}
+
+void TaskPool::run(const TaskHandle &task) {
+  try {
+    task->work();
+  } catch (...) {
+    task->error = std::current_exception();
+  }
+  task->work = nullptr; // Drop captures now, not when the handle dies.
+
+  std::vector<TaskHandle> released;
+  {
+    std::lock_guard<std::mutex> lock(graphMutex);
+    task->done = true;
+    for (const auto &dependent : task->dependents) {
+      if (--dependent->waitingOn == 0) released.push_back(dependent);
+    }
+    task->dependents.clear();
+  }
+  for (const auto &dependent : released) enqueue(dependent);
+
+  { std::lock_guard<std::mutex> lock(sleepMutex); }
+  taskFinished.notify_all();
+}
+
+void TaskPool::workerLoop(const size_t worker) {
+  currentPool = this;
+  currentWorker = worker;
+
+  while (true) {
+    if (const auto task = take(true, worker)) {
+      run(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    wakeWorker.wait(lock, [&]() { return stopping or queued > 0; });
+    if (stopping and queued == 0) return;
+  }
+}
+
+TaskPool::TaskPool(const size_t threads) :
+    queued(0),
+    nextQueue(0),
+    stopping(false) {
+  const size_t count = std::max(threads, size_t(1));
+  for (size_t i = 0; i < count; ++i)
+    queues.emplace_back(new WorkerQueue());
+  for (size_t i = 0; i < count; ++i)
+    workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeWorker.notify_all();
+  for (auto &worker : workers) worker.join();
+}
+
+TaskPool &TaskPool::global() {
+  static TaskPool pool;
+  return pool;
+}
+
+TaskHandle TaskPool::submit(std::function<void()> work,
+                            const std::vector<TaskHandle> &after,
+                            const TaskPriority priority) {
+  auto task = std::make_shared<Task>(std::move(work), priority);
+
+  {
+    std::lock_guard<std::mutex> lock(graphMutex);
+    for (const auto &dependency : after) {
+      if (dependency and !dependency->done) {
+        dependency->dependents.push_back(task);
+        task->waitingOn++;
+      }
+    }
+    if (task->waitingOn > 0) return task;
+  }
+
+  enqueue(task);
+  return task;
+}
+
+void TaskPool::wait(const TaskHandle &task) {
+  if (!task) return;
+
+  size_t worker;
+  const bool isWorker = onWorker(worker);
+  while (!task->done) {
+    // Workers help out rather than sit on a thread the pool needs.
+    if (isWorker) {
+      if (const auto other = take(true, worker)) {
+        run(other);
+        continue;
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    if (isWorker) {
+      taskFinished.wait_for(lock, std::chrono::milliseconds(1), [&]() {
+        return bool(task->done) or queued > 0;
+      });
+    } else {
+      taskFinished.wait(lock, [&]() { return bool(task->done); });
+    }
+  }
+}
+
+void TaskPool::parallelFor(const size_t begin, const size_t end,
+                           const std::function<void(size_t)> &f,
+                           const size_t grain,
+                           const TaskPriority priority) {
+  if (end <= begin) return;
+  const size_t count = end - begin, minChunk = std::max(grain, size_t(1));
+  const size_t chunks =
+      std::min((count + minChunk - 1) / minChunk, workers.size() * 4);
+  const size_t chunkSize = (count + chunks - 1) / chunks;
+
+  std::vector<TaskHandle> tasks;
+  for (size_t first = begin; first < end; first += chunkSize) {
+    const size_t last = std::min(first + chunkSize, end);
+    tasks.push_back(submit([&f, first, last]() {
+      for (size_t i = first; i < last; ++i) f(i);
+    }, {}, priority));
+  }
+
+  for (const auto &task : tasks) wait(task);
+  for (const auto &task : tasks) {
+    if (const auto error = task->getError()) std::rethrow_exception(error);
+  }
+}
+
+size_t TaskPool::threadCount() const {
+  return workers.size();
+}
@@ -17,20 +17,240 @@
  */
 /**
  * Gives us std::thread and std::mutex. If we're on MinGW, uses the thirdparty
- * mingw-std-threads library.
+ * mingw-std-threads library. Also a shared work-stealing pool of worker
+ * threads, with futures and parallel loops on top.
  */
+#pragma once
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
 
 #ifdef __linux
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #endif
 
 #ifdef __APPLE__
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #endif
 
 #ifdef _WIN32
 #include <mingw.thread.h>
 #include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
 #endif
+
+/**
+ * Tasks of higher priority are taken first, from any worker's queue.
+ */
+enum class TaskPriority {
+  High, Normal, Low, MAX
+};
+
+/**
+ * A unit of work submitted to a TaskPool. It runs once every task it was
+ * submitted after has finished. If it throws, the exception is kept here.
+ */
+class Task {
+  friend class TaskPool;
+ private:
+  std::function<void()> work;
+  const TaskPriority priority;
+  size_t waitingOn; // Unfinished tasks this one runs after.
+  std::vector<std::shared_ptr<Task>> dependents;
+  std::atomic<bool> done;
+  std::exception_ptr error;
+
+ public:
+  Task(std::function<void()> &&work, const TaskPriority priority);
+  Task(const Task &) = delete;
+
+  bool isDone() const;
+  std::exception_ptr getError() const; // Only meaningful once done.
+
+};
+
+using TaskHandle = std::shared_ptr<Task>;
+
+template<typename T>
+class Future;
+
+/**
+ * Fixed set of worker threads that run Tasks as their dependencies finish.
+ * One pool is shared by the process, so background jobs don't each spawn
+ * their own thread.
+ *
+ * Each worker has its own queue: it takes its newest task first, and steals
+ * the oldest from the others when it runs dry. Tasks submitted from a worker
+ * go on its own queue, others are spread around. Waiting from inside a
+ * worker runs other tasks meanwhile, so nested parallelism can't deadlock.
+ */
+class TaskPool {
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<TaskHandle> tasks[size_t(TaskPriority::MAX)];
+  };
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> queued, nextQueue;
+  std::atomic<bool> stopping;
+
+  std::mutex graphMutex; // Guards Task::waitingOn and Task::dependents.
+  std::mutex sleepMutex;
+  std::condition_variable wakeWorker, taskFinished;
+
+  // Index of the calling thread's worker in this pool, if it's one of ours.
+  bool onWorker(size_t &worker) const;
+
+  void enqueue(const TaskHandle &task);
+  TaskHandle take(const bool isWorker, const size_t worker);
+  void run(const TaskHandle &task);
+  void workerLoop(const size_t worker);
+
+ public:
+  TaskPool(const size_t threads = std::thread::hardware_concurrency());
+  TaskPool(const TaskPool &) = delete;
+  ~TaskPool(); // Finishes every submitted task first.
+
+  // The pool shared by the process.
+  static TaskPool &global();
+
+  // Schedule work to run after a number of other tasks.
+  TaskHandle submit(std::function<void()> work,
+                    const std::vector<TaskHandle> &after = {},
+                    const TaskPriority priority = TaskPriority::Normal);
+  // Schedule work, getting a Future for its result.
+  template<typename F>
+  auto async(F f, const std::vector<TaskHandle> &after = {},
+             const TaskPriority priority = TaskPriority::Normal)
+  -> Future<decltype(f())>;
+
+  // Block until a task has finished.
+  void wait(const TaskHandle &task);
+
+  // Run f(i) for every i in [begin, end) across the pool, in chunks of at
+  // least `grain` indices, and wait for all of them. Rethrows the first
+  // exception a chunk threw.
+  void parallelFor(const size_t begin, const size_t end,
+                   const std::function<void(size_t)> &f,
+                   const size_t grain = 1,
+                   const TaskPriority priority = TaskPriority::Normal);
+
+  size_t threadCount() const;
+
+};
+
+/**
+ * The eventual result of a task submitted through TaskPool::async. get()
+ * waits for it, rethrowing what the task threw; then() chains another task
+ * on the result.
+ */
+template<typename T>
+class Future {
+ private:
+  TaskPool *pool;
+  TaskHandle task;
+  std::shared_ptr<boost::optional<T>> result;
+
+ public:
+  Future() : pool(nullptr) { }
+  Future(TaskPool &pool, const TaskHandle &task,
+         const std::shared_ptr<boost::optional<T>> &result) :
+      pool(&pool), task(task), result(result) { }
+
+  bool isReady() const { return task and task->isDone(); }
+  const TaskHandle &getTask() const { return task; }
+
+  const T &get() const {
+    pool->wait(task);
+    if (const auto error = task->getError()) std::rethrow_exception(error);
+    return result->get();
+  }
+
+  template<typename F>
+  auto then(F f, const TaskPriority priority = TaskPriority::Normal) const
+  -> Future<decltype(f(std::declval<const T &>()))> {
+    const auto parent = task;
+    const auto value = result;
+    return pool->async([parent, value, f]() mutable {
+      if (const auto error = parent->getError()) std::rethrow_exception(error);
+      return f(value->get());
+    }, {task}, priority);
+  }
+
+};
+
+template<>
+class Future<void> {
+ private:
+  TaskPool *pool;
+  TaskHandle task;
+
+ public:
+  Future() : pool(nullptr) { }
+  Future(TaskPool &pool, const TaskHandle &task) :
+      pool(&pool), task(task) { }
+
+  bool isReady() const { return task and task->isDone(); }
+  const TaskHandle &getTask() const { return task; }
+
+  void get() const {
+    pool->wait(task);
+    if (const auto error = task->getError()) std::rethrow_exception(error);
+  }
+
+  template<typename F>
+  auto then(F f, const TaskPriority priority = TaskPriority::Normal) const
+  -> Future<decltype(f())> {
+    const auto parent = task;
+    return pool->async([parent, f]() mutable {
+      if (const auto error = parent->getError()) std::rethrow_exception(error);
+      return f();
+    }, {task}, priority);
+  }
+
+};
+
+namespace detail {
+
+template<typename R>
+struct TaskLauncher {
+  template<typename F>
+  static Future<R> launch(TaskPool &pool, F &&f,
+                          const std::vector<TaskHandle> &after,
+                          const TaskPriority priority) {
+    auto result = std::make_shared<boost::optional<R>>();
+    const auto task = pool.submit(
+        [result, f]() mutable { *result = f(); }, after, priority);
+    return Future<R>(pool, task, result);
+  }
+};
+
+template<>
+struct TaskLauncher<void> {
+  template<typename F>
+  static Future<void> launch(TaskPool &pool, F &&f,
+                             const std::vector<TaskHandle> &after,
+                             const TaskPriority priority) {
+    return Future<void>(pool, pool.submit(std::forward<F>(f), after, priority));
+  }
+};
+
+}
+
+template<typename F>
+auto TaskPool::async(F f, const std::vector<TaskHandle> &after,
+                     const TaskPriority priority) -> Future<decltype(f())> {
+  return detail::TaskLauncher<decltype(f())>::launch(
+      *this, std::move(f), after, priority);
+}
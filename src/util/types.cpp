@@ -29,13 +29,22 @@
 TimeStats::TimeStats(const RollingSampler<TimeDiff> &sampler) :
     min(sampler.min()),
     mean(sampler.mean<TimeDiff>()),
-    max(sampler.max()) { }
+    max(sampler.max()),
+    p50(sampler.percentile(0.5)),
+    p95(sampler.percentile(0.95)),
+    p99(sampler.percentile(0.99)) { }
 
 std::string TimeStats::print() const {
   return printTimeDiff(mean) + ":"
       + printTimeDiff(min) + "->"
       + printTimeDiff(max);
 }
+
+std::string TimeStats::printPercentiles() const {
+  return printTimeDiff(p50) + "/"
+      + printTimeDiff(p95) + "/"
+      + printTimeDiff(p99);
+}
 /**
  * MovementLaws.
  */
@@ -203,6 +203,21 @@ class RollingSampler {
     if (data.size() == 0) return 0;
     return *std::min_element(data.begin(), data.end());
   }
+
+  // The sample below which a fraction p (in [0, 1]) of the samples fall.
+  Data percentile(const double p) const {
+    if (data.size() == 0) return 0;
+    std::vector<Data> sorted(data);
+    const size_t rank = std::min(
+        data.size() - 1, size_t(clamp(0.0, 1.0, p) * double(data.size())));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+  }
+
+  // Samples, oldest first.
+  const std::vector<Data> &getData() const {
+    return data;
+  }
 };
 
 struct TimeStats {
@@ -210,8 +225,73 @@ struct TimeStats {
   TimeStats(const RollingSampler<TimeDiff> &sampler);
 
   TimeDiff min, mean, max;
+  TimeDiff p50, p95, p99;
   std::string print() const;
+  std::string printPercentiles() const;
+
+};
+
+/**
+ * A fixed number of slots, written in a circle: once it's full, pushing
+ * recycles the oldest slot, without allocating. Indexed oldest first.
+ */
+template<typename T>
+class RingBuffer {
+ private:
+  std::vector<T> slots;
+  size_t start, count;
+
+ public:
+  RingBuffer() = delete;
+  RingBuffer(const size_t capacity) :
+      slots(std::max(capacity, size_t(1))), start(0), count(0) { }
+
+  // The slot for a new element, left as its last occupant left it.
+  T &push() {
+    if (count < slots.size()) {
+      count++;
+    } else {
+      start = (start + 1) % slots.size();
+    }
+    return back();
+  }
+
+  void push(const T &value) {
+    push() = value;
+  }
+
+  void clear() {
+    start = 0;
+    count = 0;
+  }
+
+  T &operator[](const size_t i) {
+    return slots[(start + i) % slots.size()];
+  }
+
+  const T &operator[](const size_t i) const {
+    return slots[(start + i) % slots.size()];
+  }
+
+  T &back() {
+    return (*this)[count - 1];
+  }
 
+  const T &back() const {
+    return (*this)[count - 1];
+  }
+
+  size_t size() const {
+    return count;
+  }
+
+  bool empty() const {
+    return count == 0;
+  }
+
+  size_t capacity() const {
+    return slots.size();
+  }
 };
 
 /****
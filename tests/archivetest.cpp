@@ -4,8 +4,8 @@
 #include "util/archive.hpp"
 
 /**
- * Our small 7zip wrapper for reading zip archives
- * does what one might expect it to.
+ * Our small zip reader, and the Directory utility, do what one might expect
+ * them to.
  */
 class ArchiveTest : public testing::Test {
  public:
@@ -53,7 +53,8 @@ TEST_F(ArchiveTest, DirectoryTest) {
 }
 
 /**
- * Archive lets us load archives asynchronously and get their contents as a Directory.
+ * Archive opens zip files in-process, with a blocking load, and reads their
+ * members into memory.
  */
 TEST_F(ArchiveTest, ExtractTest) {
   {
@@ -61,14 +62,15 @@ TEST_F(ArchiveTest, ExtractTest) {
     Archive archive(getTestPath("archive-that-does-not-exist.zip")); // The test archive.
     ASSERT_EQ(archive.isDone(), false);
 
-    // Then we load the archive, and join the worker thread...
+    // Then we load the archive...
     archive.load(); // blocking call
 
     // And things are loaded.
     ASSERT_TRUE(archive.isDone());
 
     // We get an error instead of a result because the path that we specified doesn't exist.
-    ASSERT_EQ((bool) archive.getResult(), false);
+    ASSERT_EQ(archive.isOpen(), false);
+    ASSERT_FALSE(bool(archive.readFile("asdf")));
   }
 
   {
@@ -77,10 +79,16 @@ TEST_F(ArchiveTest, ExtractTest) {
     archive.load();
 
     // Now it works.
-   ASSERT_EQ((bool) archive.getResult(), true);
-   const Directory &dir = *archive.getResult();
-   ASSERT_EQ(dir.name, "test.zip");
-   ASSERT_EQ(dir.files.size(), size_t(2));
+    ASSERT_TRUE(archive.isDone());
+    ASSERT_EQ(archive.isOpen(), true);
+    ASSERT_EQ(archive.getName(), "test.zip");
+    ASSERT_EQ(archive.getTopFiles().size(), size_t(2));
+
+    // Members are read straight into memory.
+    ASSERT_TRUE(archive.hasFile("asdf"));
+    ASSERT_EQ(archive.readFile("asdf").get(), "asdf\n");
+    ASSERT_FALSE(archive.hasFile("file-that-does-not-exist"));
+    ASSERT_FALSE(bool(archive.readFile("file-that-does-not-exist")));
   }
 }
 
@@ -90,9 +98,14 @@ TEST_F(ArchiveTest, ExtractTest) {
 TEST_F(ArchiveTest, EnvironmentTest) {
   Archive archive(getEnvironmentPath("demo.sky"));
   archive.load();
-  ASSERT_TRUE((bool) archive.getResult());
+  ASSERT_TRUE(archive.isOpen());
+
+  ASSERT_EQ(archive.getTopFiles().size(), size_t(3));
+  ASSERT_TRUE(archive.hasFile("map.json"));
 
-  const Directory &dir = *archive.getResult();
-  ASSERT_EQ(dir.files.size(), size_t(3));
-  ASSERT_TRUE(bool(dir.getTopFile("map.json")));
+  // map.json is deflated; it inflates to something that parses.
+  const auto mapData = archive.readFile("map.json");
+  ASSERT_TRUE(bool(mapData));
+  ASSERT_EQ(mapData->front(), '{');
+  ASSERT_EQ(mapData->back(), '}');
 }
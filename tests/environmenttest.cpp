@@ -93,3 +93,80 @@ TEST_F(EnvironmentTest, ScriptTest) {
   // TODO: more
 }
 
+
+/**
+ * Loading the same file twice takes its components from the cache, and
+ * shares them.
+ */
+TEST_F(EnvironmentTest, CacheTest) {
+  sky::EnvironmentCache cache;
+
+  sky::Environment first("demo", cache);
+  first.joinWorker();
+  ASSERT_FALSE(first.loadingErrored());
+  ASSERT_EQ(cache.getStats().misses, 1u);
+  ASSERT_EQ(cache.getStats().entries, 1u);
+
+  sky::Environment second("demo", cache);
+  second.joinWorker();
+  ASSERT_FALSE(second.loadingErrored());
+  ASSERT_EQ(cache.getStats().hits, 1u);
+  ASSERT_EQ(second.getMap(), first.getMap());
+
+  second.loadMore(true, true);
+  second.joinWorker();
+  first.loadMore(true, true);
+  first.joinWorker();
+  ASSERT_EQ(first.getVisuals(), second.getVisuals());
+  ASSERT_EQ(first.getMechanics(), second.getMechanics());
+
+  // Entries are charged for what their components hold in memory.
+  ASSERT_GE(first.getMap()->residentBytes(),
+            first.getMap()->getObstacles().size() * sizeof(sky::MapObstacle));
+  ASSERT_EQ(cache.getStats().bytes, first.getMap()->residentBytes()
+      + sizeof(sky::Visuals) + sizeof(sky::Mechanics));
+
+  // Over the limit, older entries are evicted; the components they handed
+  // out stay alive.
+  sky::Environment other("asteroids", cache);
+  other.joinWorker();
+  ASSERT_EQ(cache.getStats().entries, 2u);
+  cache.setByteLimit(1);
+  ASSERT_EQ(cache.getStats().entries, 1u);
+  ASSERT_EQ(cache.getStats().evictions, 1u);
+  ASSERT_EQ(first.getMap()->getDimensions().x, 1600);
+
+  sky::Environment third("demo", cache);
+  third.joinWorker();
+  ASSERT_NE(third.getMap(), first.getMap());
+}
+
+/**
+ * Stages report progress and timings, and visuals and mechanics can be asked
+ * for before the map is done.
+ */
+TEST_F(EnvironmentTest, StageTest) {
+  sky::EnvironmentCache cache;
+  TaskPool pool(2);
+  sky::Environment environment("demo", cache, pool);
+  environment.loadMore(true, true);
+  environment.joinWorker();
+
+  ASSERT_TRUE(environment.loadingIdle());
+  ASSERT_FALSE(environment.loadingErrored());
+  ASSERT_EQ(environment.loadingProgress(), 1);
+  ASSERT_TRUE(environment.getMap() and environment.getVisuals()
+                  and environment.getMechanics());
+
+  const auto times = environment.getStageTimes();
+  ASSERT_EQ(times.size(), 4u);
+  for (const auto stage : {"archive", "map", "visuals", "mechanics"})
+    ASSERT_EQ(times.count(stage), 1u);
+
+  // A cancelled environment skips what it hasn't started.
+  sky::Environment cancelled("demo", cache, pool);
+  cancelled.cancel();
+  cancelled.loadMore(true, false);
+  cancelled.joinWorker();
+  ASSERT_FALSE(bool(cancelled.getVisuals()));
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <gtest/gtest.h>
+#include "engine/sky/sky.hpp"
+#include "util/printer.hpp"
+
+/**
+ * Timing the batched flight model against the per-plane one.
+ */
+class FlightBench: public testing::Test {
+ public:
+  FlightBench() { }
+
+  // Average milliseconds per call of f over a number of runs.
+  static double timeMs(const size_t runs, std::function<void()> f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < runs; ++i) f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count()
+        / double(runs);
+  }
+
+  // Time a Sky ticking with a number of planes, flying on a grid spaced
+  // wide enough that box2d broadphase doesn't see any pairs.
+  static double timeSky(const size_t planes, const bool batched) {
+    sky::Arena arena(sky::ArenaInit("bench arena", "NULL", sky::ArenaMode::Lobby),
+                     {}, true);
+    sky::Map nullMap;
+    sky::Sky sky(arena, nullMap, sky::SkyInit(), nullptr);
+    sky.setBatchedFlight(batched);
+
+    sky::PlaneControls controls;
+    controls.doAction(sky::Action::Thrust, true);
+    sky::ParticipationInput input;
+    input.controls = controls;
+
+    for (size_t i = 0; i < planes; ++i) {
+      arena.connectPlayer("bench plane");
+      auto &participation = sky.getParticipation(*arena.getPlayer(PID(i)));
+      participation.spawn({}, {float(i % 64) * 100, float(i / 64) * 100},
+                          float((i * 37) % 360));
+      participation.applyInput(input);
+    }
+
+    arena.tick(1.0f / 60.0f); // Warm up.
+    return timeMs(60, [&]() { arena.tick(1.0f / 60.0f); });
+  }
+
+  // Time the flight kernel alone.
+  static double timeKernel(const size_t planes, const bool scalar) {
+    sky::FlightBatch batch;
+    const sky::PlaneTuning tuning;
+    sky::PlaneControls controls;
+    controls.doAction(sky::Action::Thrust, true);
+
+    for (size_t i = 0; i < planes; ++i)
+      batch.push(sky::PlaneState(tuning, {}, float((i * 37) % 360)),
+                 tuning, controls);
+
+    const size_t runs = 200000 / planes + 10;
+    if (scalar) return timeMs(runs, [&]() { batch.tickScalar(1.0f / 60.0f); });
+    return timeMs(runs, [&]() { batch.tick(1.0f / 60.0f); });
+  }
+
+};
+
+TEST_F(FlightBench, Planes) {
+  appLog("Flight kernel backend: " + sky::FlightBatch::describeBackend());
+  for (const size_t planes : {32, 256, 4096}) {
+    StringPrinter p;
+    p.print(std::to_string(planes) + " planes: ");
+    p.print("kernel scalar " + std::to_string(timeKernel(planes, true)) + "ms, ");
+    p.print("kernel simd " + std::to_string(timeKernel(planes, false)) + "ms, ");
+    p.print("sky per-plane " + std::to_string(timeSky(planes, false)) + "ms, ");
+    p.print("sky batched " + std::to_string(timeSky(planes, true)) + "ms");
+    appLog(p.getString());
+  }
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "engine/sky/sky.hpp"
+
+/**
+ * The batched flight model agrees with Plane::tickFlight.
+ */
+class FlightTest: public testing::Test {
+ public:
+  sky::Arena arena;
+  sky::Map nullMap;
+  sky::Sky referenceSky, batchedSky;
+
+  FlightTest() :
+      arena(sky::ArenaInit("special arena", "NULL", sky::ArenaMode::Lobby), {}, true),
+      nullMap(),
+      referenceSky(arena, nullMap, sky::SkyInit(), nullptr),
+      batchedSky(arena, nullMap, sky::SkyInit(), nullptr) {
+    batchedSky.setBatchedFlight(true);
+  }
+
+  // Spawn a plane in both skies, and apply the same controls.
+  void spawnPlane(const sf::Vector2f &pos, const float rot,
+                  const std::vector<sky::Action> &actions) {
+    arena.connectPlayer("nameless plane");
+    auto &player = *arena.getPlayer(PID(arena.getPlayers().size() - 1));
+
+    sky::PlaneControls controls;
+    for (const auto action : actions) controls.doAction(action, true);
+    sky::ParticipationInput input;
+    input.controls = controls;
+
+    for (auto sky : {&referenceSky, &batchedSky}) {
+      auto &participation = sky->getParticipation(player);
+      participation.spawn({}, pos, rot);
+      participation.applyInput(input);
+    }
+  }
+
+};
+
+/**
+ * Ticking planes through the FlightBatch produces the same state as ticking
+ * them one by one, within float tolerance.
+ */
+TEST_F(FlightTest, BatchedTest) {
+  spawnPlane({0, 0}, 0, {});
+  spawnPlane({200, 0}, 90, {sky::Action::Thrust});
+  spawnPlane({400, 0}, -90, {sky::Action::Thrust, sky::Action::Left});
+  spawnPlane({600, 0}, 45, {sky::Action::Reverse});
+  spawnPlane({800, 0}, 180, {sky::Action::Right});
+  spawnPlane({0, 200}, 270, {sky::Action::Reverse, sky::Action::Right});
+  spawnPlane({200, 200}, 10, {sky::Action::Thrust, sky::Action::Right});
+  spawnPlane({400, 200}, -30, {sky::Action::Left});
+  spawnPlane({600, 200}, 135, {sky::Action::Thrust});
+
+  for (int i = 0; i < 120; ++i) arena.tick(1.0f / 60.0f);
+
+  arena.forPlayers([&](sky::Player &player) {
+    const auto &reference =
+        referenceSky.getParticipation(player).plane->getState();
+    const auto &batched =
+        batchedSky.getParticipation(player).plane->getState();
+
+    EXPECT_EQ(reference.stalled, batched.stalled);
+    EXPECT_NEAR(reference.physical.pos.x, batched.physical.pos.x, 0.05);
+    EXPECT_NEAR(reference.physical.pos.y, batched.physical.pos.y, 0.05);
+    EXPECT_NEAR(reference.physical.vel.x, batched.physical.vel.x, 0.05);
+    EXPECT_NEAR(reference.physical.vel.y, batched.physical.vel.y, 0.05);
+    EXPECT_NEAR(reference.physical.rot, batched.physical.rot, 0.01);
+    EXPECT_NEAR(reference.airspeed, batched.airspeed, 0.001);
+    EXPECT_NEAR(reference.throttle, batched.throttle, 0.001);
+    EXPECT_NEAR(reference.afterburner, batched.afterburner, 0.001);
+    EXPECT_NEAR(reference.energy, batched.energy, 0.001);
+  });
+}
+
+/**
+ * Every SIMD backend agrees bit-for-bit with the scalar one.
+ */
+TEST_F(FlightTest, BackendTest) {
+  sky::FlightBatch simd, scalar;
+  const sky::PlaneTuning tuning;
+
+  for (int i = 0; i < 37; ++i) { // Not a multiple of any lane width.
+    sky::PlaneState state(tuning, {0, 0}, float(i * 23));
+    state.physical.vel = {float((i * 37) % 300) - 150,
+                          float((i * 91) % 300) - 150};
+    state.stalled = (i % 3) == 0;
+    state.airspeed = float(i % 10) / 10.0f;
+    state.throttle = float(i % 7) / 7.0f;
+    state.energy = float(i % 5) / 5.0f;
+
+    sky::PlaneControls controls;
+    if (i % 2) controls.doAction(sky::Action::Thrust, true);
+    if (i % 4 == 1) controls.doAction(sky::Action::Left, true);
+    if (i % 5 == 2) controls.doAction(sky::Action::Reverse, true);
+
+    simd.push(state, tuning, controls);
+    scalar.push(state, tuning, controls);
+  }
+
+  for (int i = 0; i < 60; ++i) {
+    simd.tick(1.0f / 60.0f);
+    scalar.tickScalar(1.0f / 60.0f);
+  }
+
+  EXPECT_EQ(simd.velX, scalar.velX);
+  EXPECT_EQ(simd.velY, scalar.velY);
+  EXPECT_EQ(simd.rotvel, scalar.rotvel);
+  EXPECT_EQ(simd.stalled, scalar.stalled);
+  EXPECT_EQ(simd.airspeed, scalar.airspeed);
+  EXPECT_EQ(simd.throttle, scalar.throttle);
+  EXPECT_EQ(simd.afterburner, scalar.afterburner);
+  EXPECT_EQ(simd.leftoverX, scalar.leftoverX);
+  EXPECT_EQ(simd.leftoverY, scalar.leftoverY);
+  EXPECT_EQ(simd.energy, scalar.energy);
+}
@@ -0,0 +1,185 @@
+#include <thread>
+#include <gtest/gtest.h>
+#include "engine/environment/map.hpp"
+
+/**
+ * Geometric queries over a Map's obstacles.
+ */
+class MapTest: public testing::Test {
+ public:
+  sky::Map map;
+
+  MapTest() :
+      map({1600, 900},
+          {
+              // A square, 100 wide, at (200, 200).
+              sky::MapObstacle({200, 200},
+                               {{0, 0}, {100, 0}, {100, 100}, {0, 100}}, 0),
+              // An L shape at (600, 200), with its notch at the top right.
+              sky::MapObstacle({600, 200},
+                               {{0, 0}, {50, 0}, {50, 50}, {100, 50},
+                                {100, 100}, {0, 100}}, 0)
+          },
+          {sky::SpawnPoint({250, 250}, 0, sky::Team::Red),
+           sky::SpawnPoint({500, 500}, 0, sky::Team::Red)}) { }
+
+};
+
+/**
+ * Rays and segments stop at the nearest obstacle edge.
+ */
+TEST_F(MapTest, RayTest) {
+  const auto &geometry = map.getGeometry();
+
+  const auto hit = geometry.castRay({0, 250}, {1000, 250});
+  ASSERT_TRUE(bool(hit));
+  ASSERT_EQ(hit->obstacle, 0u);
+  ASSERT_NEAR(hit->point.x, 200, 0.01);
+  ASSERT_NEAR(hit->normal.x, -1, 0.01);
+
+  // Along the L's notch, the square comes first; past it, the L does.
+  const auto notch = geometry.castRay({0, 225}, {1000, 225});
+  ASSERT_TRUE(bool(notch));
+  ASSERT_EQ(notch->obstacle, 0u);
+  const auto pastSquare = geometry.castRay({400, 225}, {1000, 225});
+  ASSERT_TRUE(bool(pastSquare));
+  ASSERT_NEAR(pastSquare->point.x, 600, 0.01);
+  ASSERT_FALSE(bool(geometry.castRay({660, 225}, {1000, 225}))); // In the notch.
+
+  ASSERT_FALSE(geometry.lineOfSight({0, 250}, {1000, 250}));
+  ASSERT_TRUE(geometry.lineOfSight({0, 500}, {1000, 500}));
+
+  std::vector<optional<sky::RayHit>> hits;
+  geometry.castRays({{{0, 250}, {1000, 250}}, {{0, 500}, {1000, 500}}}, hits);
+  ASSERT_EQ(hits.size(), 2u);
+  ASSERT_TRUE(bool(hits[0]));
+  ASSERT_FALSE(bool(hits[1]));
+}
+
+/**
+ * Point, distance and box queries respect non-convex obstacles.
+ */
+TEST_F(MapTest, PointTest) {
+  const auto &geometry = map.getGeometry();
+
+  ASSERT_TRUE(geometry.insideObstacle({250, 250}));
+  ASSERT_TRUE(geometry.insideObstacle({625, 225}));
+  ASSERT_FALSE(geometry.insideObstacle({675, 225})); // In the notch.
+  ASSERT_FALSE(geometry.insideObstacle({100, 100}));
+
+  ASSERT_NEAR(geometry.nearestDistance({150, 250}), 50, 0.01);
+  ASSERT_NEAR(geometry.nearestDistance({675, 225}), 25, 0.01);
+  ASSERT_EQ(geometry.nearestDistance({150, 250}, 10), 10);
+
+  std::vector<size_t> obstacles;
+  geometry.queryBox(sky::AABB({0, 0}, {400, 400}), obstacles);
+  ASSERT_EQ(obstacles, std::vector<size_t>({0}));
+
+  // Spawn points inside obstacles are passed over.
+  ASSERT_EQ(map.pickSpawnPoint(sky::Team::Red).pos, sf::Vector2f(500, 500));
+}
+
+/**
+ * The BVH agrees with brute force on a larger map, from several threads.
+ */
+TEST_F(MapTest, BVHTest) {
+  std::vector<sky::MapObstacle> obstacles;
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 10; ++y) {
+      obstacles.emplace_back(
+          sf::Vector2f(x * 150.0f, y * 90.0f),
+          std::vector<sf::Vector2f>{{0, 0}, {float(20 + x), 0},
+                                    {float(20 + x), float(30 + y)}}, 0);
+    }
+  }
+  const sky::Map bigMap({3000, 900}, obstacles, {});
+  const auto &geometry = bigMap.getGeometry();
+
+  const auto bruteForce = [&](const sf::Vector2f &from, const sf::Vector2f &to) {
+    bool hit = false;
+    for (const auto &obstacle : obstacles) {
+      const auto &vs = obstacle.localVertices;
+      for (size_t i = 0; i < vs.size(); ++i) {
+        const sf::Vector2f a = obstacle.pos + vs[i],
+            b = obstacle.pos + vs[(i + 1) % vs.size()];
+        const sf::Vector2f r = to - from, s = b - a;
+        const float denom = r.x * s.y - r.y * s.x;
+        if (denom == 0) continue;
+        const sf::Vector2f q = a - from;
+        const float t = (q.x * s.y - q.y * s.x) / denom,
+            u = (q.x * r.y - q.y * r.x) / denom;
+        hit |= t >= 0 and t <= 1 and u >= 0 and u <= 1;
+      }
+    }
+    return hit;
+  };
+
+  std::vector<std::thread> readers;
+  std::vector<int> mismatches(4, 0);
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      for (int i = 0; i < 500; ++i) {
+        const int k = i * 4 + t;
+        const sf::Vector2f from(float((k * 37) % 3000), float((k * 53) % 900)),
+            to(float((k * 91) % 3000), float((k * 17) % 900));
+        if (geometry.lineOfSight(from, to) == bruteForce(from, to))
+          mismatches[t]++;
+      }
+    });
+  }
+  for (auto &reader : readers) reader.join();
+
+  for (const int m : mismatches) ASSERT_EQ(m, 0);
+}
+
+/**
+ * Maps survive compilation to .skymap, and damaged files are turned away.
+ */
+TEST_F(MapTest, CompiledTest) {
+  const std::string compiled = map.saveCompiled();
+  const auto loaded = sky::Map::loadCompiled(compiled.data(), compiled.size());
+  ASSERT_TRUE(bool(loaded));
+
+  ASSERT_EQ(loaded->getDimensions(), map.getDimensions());
+  ASSERT_EQ(loaded->getObstacles().size(), 2u);
+  for (size_t i = 0; i < 2; ++i) {
+    const auto &x = map.getObstacles()[i], &y = loaded->getObstacles()[i];
+    ASSERT_EQ(x.pos, y.pos);
+    ASSERT_EQ(x.localVertices, y.localVertices);
+    ASSERT_EQ(x.triangles, y.triangles);
+  }
+  ASSERT_EQ(map.getObstacles()[1].triangles.size(), 12u); // The L: 4 triangles.
+  ASSERT_EQ(loaded->getSpawnPoints().size(), 2u);
+  ASSERT_EQ(loaded->getSpawnPoints()[1].team, sky::Team::Red);
+
+  // The spatial index comes along.
+  const auto &geometry = loaded->getGeometry();
+  ASSERT_TRUE(geometry.insideObstacle({625, 225}));
+  ASSERT_FALSE(geometry.insideObstacle({675, 225}));
+  const auto hit = geometry.castRay({0, 250}, {1000, 250});
+  ASSERT_TRUE(bool(hit));
+  ASSERT_NEAR(hit->point.x, 200, 0.01);
+
+  // Flipped bits, truncation and trailing junk are all caught.
+  std::string damaged(compiled);
+  damaged[damaged.size() / 2] ^= 0x40;
+  ASSERT_FALSE(bool(sky::Map::loadCompiled(damaged.data(), damaged.size())));
+  ASSERT_FALSE(bool(sky::Map::loadCompiled(compiled.data(),
+                                           compiled.size() - 1)));
+  damaged = compiled + "junk";
+  ASSERT_FALSE(bool(sky::Map::loadCompiled(damaged.data(), damaged.size())));
+
+  // So are triangles Box2D would choke on: collinear, or welded shut.
+  sky::MapObstacle sliver({0, 0}, {{0, 0}, {50, 0}, {100, 0}, {0, 100}}, 0);
+  sliver.triangles = {0, 1, 2};
+  damaged = sky::Map({1600, 900}, {sliver}, {}).saveCompiled();
+  ASSERT_FALSE(bool(sky::Map::loadCompiled(damaged.data(), damaged.size())));
+  sliver.localVertices[1] = {0.1f, 0};
+  sliver.triangles = {0, 1, 3};
+  damaged = sky::Map({1600, 900}, {sliver}, {}).saveCompiled();
+  ASSERT_FALSE(bool(sky::Map::loadCompiled(damaged.data(), damaged.size())));
+
+  // The null map compiles too.
+  const std::string null = sky::Map().saveCompiled();
+  ASSERT_TRUE(bool(sky::Map::loadCompiled(null.data(), null.size())));
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "engine/sky/sky.hpp"
+
+/**
+ * Projectiles fly, hit things and are networked as spawn events.
+ */
+class ProjectileTest: public testing::Test {
+ public:
+  sky::Arena arena;
+  sky::Map nullMap;
+  sky::Sky sky;
+
+  ProjectileTest() :
+      arena(sky::ArenaInit("special arena", "NULL", sky::ArenaMode::Lobby), {}, true),
+      nullMap(),
+      sky(arena, nullMap, sky::SkyInit(), nullptr) { }
+
+};
+
+/**
+ * Paths are swept against rotated hitboxes.
+ */
+TEST_F(ProjectileTest, SweepTest) {
+  const sky::ProjectileTarget level(0, {100, 100}, 0, {40, 10});
+
+  // Straight through the middle, entering at the left edge.
+  const auto fraction = sky::Projectiles::sweepTarget({0, 100}, {200, 100}, level);
+  ASSERT_TRUE(bool(fraction));
+  ASSERT_NEAR(*fraction, 0.4, 0.001);
+
+  // Passing above, or stopping short.
+  ASSERT_FALSE(sky::Projectiles::sweepTarget({0, 90}, {200, 90}, level));
+  ASSERT_FALSE(sky::Projectiles::sweepTarget({0, 100}, {50, 100}, level));
+
+  // The same path above a box turned upright now crosses it.
+  const sky::ProjectileTarget upright(0, {100, 100}, 90, {40, 10});
+  ASSERT_TRUE(bool(sky::Projectiles::sweepTarget({0, 90}, {200, 90}, upright)));
+}
+
+/**
+ * Projectiles damage the planes they hit, and are stopped by the world's
+ * static geometry.
+ */
+TEST_F(ProjectileTest, HitTest) {
+  arena.connectPlayer("shooter");
+  arena.connectPlayer("target");
+  sky.getParticipation(*arena.getPlayer(1)).spawn({}, {400, 400}, 0);
+
+  // Fired at the target, from its left.
+  sky.spawnProjectile(sky::ProjectileSpawn(0, {200, 400}, {1000, 0}, 2, 0.25));
+  // Fired at the left map boundary.
+  sky.spawnProjectile(sky::ProjectileSpawn(0, {50, 200}, {-1000, 0}, 2, 0.25));
+  // Fired by the target at itself, which can't hit.
+  sky.spawnProjectile(sky::ProjectileSpawn(1, {350, 400}, {1000, 0}, 0.1, 0.25));
+  ASSERT_EQ(sky.getProjectiles().size(), 3u);
+
+  for (int i = 0; i < 30; ++i) arena.tick(1.0f / 60.0f);
+
+  ASSERT_EQ(sky.getProjectiles().size(), 0u);
+  const auto &target = sky.getParticipation(*arena.getPlayer(1)).plane.get();
+  ASSERT_NEAR(target.getState().health, 0.75, 0.001);
+}
+
+/**
+ * Spawns are transmitted in SkyDeltas, and simulated on the client.
+ */
+TEST_F(ProjectileTest, NetworkTest) {
+  sky::Arena remoteArena(arena.captureInitializer());
+  sky::Sky remoteSky(remoteArena, nullMap, sky.captureInitializer());
+
+  sky.spawnProjectile(sky::ProjectileSpawn(0, {200, 200}, {100, 0}, 1, 0.25));
+  const auto delta = sky.collectDelta();
+  ASSERT_TRUE(bool(delta));
+  ASSERT_EQ(delta->projectiles.size(), 1u);
+  ASSERT_FALSE(bool(sky.collectDelta()));
+
+  remoteSky.applyDelta(delta.get());
+  ASSERT_EQ(remoteSky.getProjectiles().size(), 1u);
+
+  for (int i = 0; i < 30; ++i) remoteArena.tick(1.0f / 60.0f);
+  ASSERT_NEAR(remoteSky.getProjectiles().getPos(0).x, 250, 0.01);
+}
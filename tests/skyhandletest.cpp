@@ -102,3 +102,57 @@ TEST_F(SkyHandleTest, DeltaTest) {
     ASSERT_EQ(bool(remoteSkyHandle.getSky()), false);
   }
 }
+
+/**
+ * The next environment is loaded ahead of time, and used when we start.
+ */
+TEST_F(SkyHandleTest, PrefetchTest) {
+  // The arena's environment is prefetched from the start.
+  const sky::Environment *prefetched = skyHandle.getPrefetched();
+  ASSERT_TRUE(bool(prefetched));
+  ASSERT_EQ(prefetched->url, "NULL");
+
+  skyHandle.start();
+  ASSERT_EQ(skyHandle.getEnvironment(), prefetched);
+  ASSERT_FALSE(bool(skyHandle.getPrefetched()));
+
+  // Choosing another environment starts loading it.
+  arena.applyDelta(sky::ArenaDelta::EnvChange("does-not-exist"));
+  ASSERT_TRUE(bool(skyHandle.getPrefetched()));
+  ASSERT_EQ(skyHandle.getPrefetched()->url, "does-not-exist");
+
+  // Changing our minds again replaces it, and going back to the running
+  // environment drops it.
+  arena.applyDelta(sky::ArenaDelta::EnvChange("also-does-not-exist"));
+  ASSERT_EQ(skyHandle.getPrefetched()->url, "also-does-not-exist");
+  arena.applyDelta(sky::ArenaDelta::EnvChange("NULL"));
+  ASSERT_FALSE(bool(skyHandle.getPrefetched()));
+
+  // Remotes prefetch too, and use it when the game starts.
+  sky::Arena remoteArena(arena.captureInitializer());
+  sky::SkyHandle remoteHandle(remoteArena, sky::SkyHandleInit());
+  prefetched = remoteHandle.getPrefetched();
+  ASSERT_TRUE(bool(prefetched));
+  remoteHandle.applyDelta(sky::SkyHandleDelta("NULL"));
+  ASSERT_EQ(remoteHandle.getEnvironment(), prefetched);
+}
+
+/**
+ * Cancelled prefetches are never waited on; when too many are still
+ * finishing, the next prefetch starts on a later tick.
+ */
+TEST_F(SkyHandleTest, PrefetchDeferTest) {
+  for (int i = 0; i < 10; i++) {
+    arena.applyDelta(sky::ArenaDelta::EnvChange(
+        "does-not-exist-" + std::to_string(i)));
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    const auto prefetched = skyHandle.getPrefetched();
+    if (prefetched and prefetched->url == "does-not-exist-9") break;
+    arena.tick(0.01);
+    sf::sleep(sf::milliseconds(1));
+  }
+  ASSERT_TRUE(bool(skyHandle.getPrefetched()));
+  ASSERT_EQ(skyHandle.getPrefetched()->url, "does-not-exist-9");
+}
@@ -242,3 +242,148 @@ TEST_F(SkyTest, TuningTest) {
   *tuning.accessParamByName("flight.threshold") = 42.0f;
   ASSERT_EQ(tuning.flight.threshold, 42.0f);
 }
+
+/**
+ * Static collision rules are expressed through box2d filter bits.
+ */
+TEST_F(SkyTest, CollisionFilterTest) {
+  using Type = sky::BodyTag::Type;
+  const auto collides = [](const Type x, const Type y) {
+    return (sky::CollisionFilter::mask(x) & sky::CollisionFilter::category(y))
+        and (sky::CollisionFilter::mask(y) & sky::CollisionFilter::category(x));
+  };
+
+  // Planes pass through each other.
+  ASSERT_FALSE(collides(Type::Plane, Type::Plane));
+
+  // But not through anything else.
+  ASSERT_TRUE(collides(Type::Plane, Type::Obstacle));
+  ASSERT_TRUE(collides(Type::Plane, Type::Boundary));
+  ASSERT_TRUE(collides(Type::Plane, Type::Entity));
+  ASSERT_TRUE(collides(Type::Entity, Type::Obstacle));
+
+  // And box2d honours the bits: overlapping bodies only touch when allowed.
+  const auto touches = [](const Type x, const Type y) {
+    b2World world(b2Vec2(0, 0));
+    for (const auto type : {x, y}) {
+      b2BodyDef bodyDef;
+      bodyDef.type = b2_dynamicBody;
+      b2CircleShape circle;
+      circle.m_radius = 1;
+      b2FixtureDef fixtureDef;
+      fixtureDef.shape = &circle;
+      fixtureDef.density = 1;
+      fixtureDef.filter.categoryBits = sky::CollisionFilter::category(type);
+      fixtureDef.filter.maskBits = sky::CollisionFilter::mask(type);
+      world.CreateBody(&bodyDef)->CreateFixture(&fixtureDef);
+    }
+    world.Step(1.0f / 60.0f, 8, 3);
+    for (auto contact = world.GetContactList(); contact;
+         contact = contact->GetNext()) {
+      if (contact->IsTouching()) return true;
+    }
+    return false;
+  };
+  ASSERT_FALSE(touches(Type::Plane, Type::Plane));
+  ASSERT_TRUE(touches(Type::Plane, Type::Entity));
+  ASSERT_TRUE(touches(Type::Entity, Type::Entity));
+}
+
+/**
+ * Physics steps at a fixed rate, independent of the tick delta.
+ */
+TEST_F(SkyTest, TimestepTest) {
+  const auto &physics = sky.getPhysics();
+  const TimeDiff step = physics.getTimestep().step;
+
+  arena.connectPlayer("nameless plane");
+  auto &participation = sky.getParticipation(*arena.getPlayer(0));
+  participation.spawn({}, {200, 200}, 0);
+  const auto &plane = participation.plane.get();
+
+  // Half a step accumulates without stepping, or moving anything.
+  arena.tick(step / 2);
+  ASSERT_EQ(physics.getStepStats().totalSteps, 0u);
+  ASSERT_NEAR(physics.getAlpha(), 0.5, 0.001);
+  ASSERT_EQ(plane.getState().physical.pos, sf::Vector2f(200, 200));
+
+  // Another two and a quarter steps complete two.
+  arena.tick(step * 2.25f);
+  ASSERT_EQ(physics.getStepStats().totalSteps, 2u);
+  ASSERT_NEAR(physics.getAlpha(), 0.75, 0.001);
+
+  // Both steps ran the flight model: the same as two ticks of one step.
+  {
+    sky::Arena otherArena(sky::ArenaInit("special arena", "NULL",
+                                         sky::ArenaMode::Lobby), {}, true);
+    sky::Sky otherSky(otherArena, nullMap, sky::SkyInit(), nullptr);
+    otherArena.connectPlayer("nameless plane");
+    auto &other = otherSky.getParticipation(*otherArena.getPlayer(0));
+    other.spawn({}, {200, 200}, 0);
+    otherArena.tick(step);
+    otherArena.tick(step);
+    ASSERT_NEAR(other.plane->getState().physical.vel.y,
+                plane.getState().physical.vel.y, 0.001);
+    ASSERT_NEAR(other.plane->getState().physical.pos.y,
+                plane.getState().physical.pos.y, 0.001);
+  }
+
+  // A long frame is clamped to the catch-up limit.
+  arena.tick(step * 100);
+  ASSERT_EQ(physics.getStepStats().totalSteps,
+            2 + physics.getTimestep().maxSteps);
+  ASSERT_EQ(physics.getStepStats().clampedTicks, 1u);
+}
+
+/**
+ * Bodies of destroyed components are recycled for new ones of the same shape.
+ */
+TEST_F(SkyTest, BodyPoolTest) {
+  const auto &physics = sky.getPhysics();
+  const sky::EntityState state(
+      {}, {}, sky::Shape::Circle(10), sf::Vector2f(200, 200), sf::Vector2f(0, 0));
+
+  arena.tick(0.1); // Flush the map's bodies from the stats.
+  sky.spawnEntity(state);
+  arena.tick(0.1);
+  ASSERT_EQ(physics.getPoolStats().bodiesCreated, 1u);
+  ASSERT_EQ(physics.getPoolStats().tagChunks, 0u);
+
+  // Churn through entities of the same shape; nothing new gets allocated.
+  for (int i = 0; i < 10; ++i) {
+    (*sky.getEntities().begin()).destroy();
+    arena.tick(0.1);
+    sky.spawnEntity(state);
+    arena.tick(0.1);
+    ASSERT_EQ(physics.getPoolStats().bodiesCreated, 0u);
+    ASSERT_EQ(physics.getPoolStats().bodiesRecycled, 1u);
+    ASSERT_EQ(physics.getPoolStats().tagChunks, 0u);
+  }
+
+  // A different shape can't reuse the pooled body.
+  sky.spawnEntity(sky::EntityState(
+      {}, {}, sky::Shape::Circle(20), sf::Vector2f(400, 400), sf::Vector2f(0, 0)));
+  arena.tick(0.1);
+  ASSERT_EQ(physics.getPoolStats().bodiesCreated, 1u);
+  ASSERT_EQ(physics.getPoolStats(true).bodiesRecycled, 10u);
+}
+
+/**
+ * Physical states blend for rendering between steps.
+ */
+TEST_F(SkyTest, InterpolateTest) {
+  const sky::PhysicalState from({0, 0}, {10, 0}, 350, 0),
+      to({100, 50}, {20, 0}, 10, 4);
+
+  const auto half = sky::PhysicalState::interpolate(from, to, 0.5);
+  ASSERT_NEAR(half.pos.x, 50, 0.001);
+  ASSERT_NEAR(half.pos.y, 25, 0.001);
+  ASSERT_NEAR(half.vel.x, 15, 0.001);
+  ASSERT_NEAR(half.rotvel, 2, 0.001);
+  // Through 0, not back round through 180.
+  ASSERT_NEAR(float(half.rot), 0, 0.001);
+
+  const auto end = sky::PhysicalState::interpolate(from, to, 1);
+  ASSERT_NEAR(end.pos.x, 100, 0.001);
+  ASSERT_NEAR(float(end.rot), 10, 0.001);
+}
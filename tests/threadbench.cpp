@@ -0,0 +1,50 @@
+#include <chrono>
+#include <cmath>
+#include <gtest/gtest.h>
+#include "util/threads.hpp"
+#include "util/printer.hpp"
+
+/**
+ * How TaskPool::parallelFor scales with the number of workers.
+ */
+class ThreadBench: public testing::Test {
+ public:
+  ThreadBench() { }
+
+  // Average milliseconds per call of f over a number of runs.
+  static double timeMs(const size_t runs, std::function<void()> f) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < runs; ++i) f();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count()
+        / double(runs);
+  }
+
+  // Time a loop of uneven, compute-bound iterations on a pool of some size.
+  static double timeLoop(const size_t workers, const size_t grain) {
+    TaskPool pool(workers);
+    std::vector<float> results(4096);
+    const auto body = [&](const size_t i) {
+      float x = float(i);
+      for (size_t j = 0; j < 200 + (i % 64) * 20; ++j) x = std::sqrt(x + j);
+      results[i] = x;
+    };
+
+    pool.parallelFor(0, results.size(), body, grain); // Warm up.
+    return timeMs(20, [&]() {
+      pool.parallelFor(0, results.size(), body, grain);
+    });
+  }
+
+};
+
+TEST_F(ThreadBench, Scaling) {
+  const size_t hardware = std::max(std::thread::hardware_concurrency(), 1u);
+  for (size_t workers = 1; workers <= hardware; workers *= 2) {
+    StringPrinter p;
+    p.print(std::to_string(workers) + " workers: ");
+    p.print("grain 1 " + std::to_string(timeLoop(workers, 1)) + "ms, ");
+    p.print("grain 64 " + std::to_string(timeLoop(workers, 64)) + "ms");
+    appLog(p.getString());
+  }
+}
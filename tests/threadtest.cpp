@@ -55,3 +55,127 @@ TEST_F(ThreadTest, BasicTest) {
 
 }
 
+
+/**
+ * TaskPool runs tasks after the ones they depend on.
+ */
+TEST_F(ThreadTest, TaskPoolTest) {
+  TaskPool pool(4);
+  ASSERT_EQ(pool.threadCount(), 4u);
+
+  std::mutex orderLock;
+  std::vector<int> order;
+  const auto record = [&](const int x) {
+    return [&, x]() {
+      sf::sleep(sf::milliseconds(5));
+      std::lock_guard<std::mutex> lock(orderLock);
+      order.push_back(x);
+    };
+  };
+
+  // A diamond: 1 after 0, 2 after 0, 3 after both.
+  const auto first = pool.submit(record(0));
+  const auto left = pool.submit(record(1), {first});
+  const auto right = pool.submit(record(2), {first});
+  const auto last = pool.submit(record(3), {left, right});
+
+  pool.wait(last);
+  ASSERT_TRUE(first->isDone());
+  ASSERT_TRUE(left->isDone() and right->isDone());
+  ASSERT_EQ(order.size(), 4u);
+  ASSERT_EQ(order.front(), 0);
+  ASSERT_EQ(order.back(), 3);
+
+  // Depending on finished tasks is fine.
+  const auto late = pool.submit(record(4), {first, last});
+  pool.wait(late);
+  ASSERT_EQ(order.back(), 4);
+}
+
+/**
+ * Futures carry results and exceptions, and continuations chain on them.
+ */
+TEST_F(ThreadTest, FutureTest) {
+  TaskPool pool(2);
+
+  const auto answer = pool.async([]() { return 6; })
+      .then([](const int x) { return x * 7; });
+  ASSERT_EQ(answer.get(), 42);
+  ASSERT_TRUE(answer.isReady());
+
+  const auto text = answer.then([](const int x) { return std::to_string(x); });
+  ASSERT_EQ(text.get(), "42");
+
+  bool ran = false;
+  pool.async([]() { }).then([&]() { ran = true; }).get();
+  ASSERT_TRUE(ran);
+
+  // Errors pass down the chain without running what comes after.
+  bool continued = false;
+  const auto failed = pool.async([]() -> int {
+    throw std::runtime_error("nope");
+  }).then([&](const int x) {
+    continued = true;
+    return x;
+  });
+  ASSERT_THROW(failed.get(), std::runtime_error);
+  ASSERT_FALSE(continued);
+}
+
+/**
+ * Higher priority tasks are taken first.
+ */
+TEST_F(ThreadTest, PriorityTest) {
+  TaskPool pool(1);
+
+  // Hold the only worker while we queue things up.
+  std::mutex gate;
+  std::atomic<bool> blocked(false);
+  gate.lock();
+  const auto blocker = pool.submit([&]() {
+    blocked = true;
+    gate.lock();
+    gate.unlock();
+  });
+  while (!blocked) sf::sleep(sf::milliseconds(1));
+
+  std::vector<int> order;
+  std::vector<TaskHandle> tasks;
+  tasks.push_back(pool.submit([&]() { order.push_back(2); }, {},
+                              TaskPriority::Low));
+  tasks.push_back(pool.submit([&]() { order.push_back(1); }, {},
+                              TaskPriority::Normal));
+  tasks.push_back(pool.submit([&]() { order.push_back(0); }, {},
+                              TaskPriority::High));
+  gate.unlock();
+
+  pool.wait(blocker);
+  for (const auto &task : tasks) pool.wait(task);
+  ASSERT_EQ(order, std::vector<int>({0, 1, 2}));
+}
+
+/**
+ * parallelFor covers its range exactly once, even nested inside itself.
+ */
+TEST_F(ThreadTest, ParallelForTest) {
+  TaskPool pool(4);
+
+  std::vector<std::atomic<int>> hits(1000);
+  for (auto &hit : hits) hit = 0;
+  pool.parallelFor(0, hits.size(), [&](const size_t i) { hits[i]++; }, 16);
+  for (const auto &hit : hits) ASSERT_EQ(hit, 1);
+
+  // Nested loops outnumber the workers; waiting workers run the inner chunks.
+  std::atomic<size_t> total(0);
+  pool.parallelFor(0, 32, [&](const size_t) {
+    pool.parallelFor(0, 100, [&](const size_t) { total++; });
+  });
+  ASSERT_EQ(total, 3200u);
+
+  ASSERT_THROW(pool.parallelFor(0, 10, [](const size_t i) {
+    if (i == 5) throw std::runtime_error("nope");
+  }), std::runtime_error);
+
+  // Empty ranges do nothing.
+  pool.parallelFor(5, 5, [](const size_t) { FAIL(); });
+}
@@ -2,6 +2,7 @@
 #include <gtest/gtest.h>
 #include "util/types.hpp"
 #include "util/methods.hpp"
+#include "util/profiling.hpp"
 
 /**
  * The basic utilities we have in src/util.
@@ -26,6 +27,62 @@ TEST_F(UtilTest, RollingSamplerTest) {
   EXPECT_EQ(sampler.min(), 6);
 }
 
+TEST_F(UtilTest, PercentileTest) {
+  RollingSampler<int> sampler(100);
+  EXPECT_EQ(sampler.percentile(0.5), 0);
+  for (int i = 100; i > 0; --i) sampler.push(i);
+  EXPECT_EQ(sampler.percentile(0), 1);
+  EXPECT_EQ(sampler.percentile(0.5), 51);
+  EXPECT_EQ(sampler.percentile(0.95), 96);
+  EXPECT_EQ(sampler.percentile(1), 100);
+  EXPECT_EQ(sampler.getData().front(), 100); // Unsorted.
+}
+
+TEST_F(UtilTest, ProfileScopeTest) {
+  struct Sink: public ProfileSink {
+    std::vector<ProfileStage> stages;
+    void record(const ProfileStage stage, const TimeDiff time) override {
+      EXPECT_GE(time, 0);
+      stages.push_back(stage);
+    }
+  } sink;
+
+  { ProfileScope scope(ProfileStage::Tick); } // No sink, nothing happens.
+  setProfileSink(&sink);
+  {
+    ProfileScope outer(ProfileStage::Tick);
+    ProfileScope inner(ProfileStage::Subsystems);
+  }
+  setProfileSink(nullptr);
+
+  ASSERT_EQ(sink.stages, std::vector<ProfileStage>(
+      {ProfileStage::Subsystems, ProfileStage::Tick}));
+
+  const size_t before = allocationCount();
+  countAllocation();
+  EXPECT_EQ(allocationCount(), before + 1);
+}
+
+TEST_F(UtilTest, RingBufferTest) {
+  RingBuffer<std::vector<int>> ring(3);
+  EXPECT_TRUE(ring.empty());
+  for (int i = 0; i < 5; ++i) ring.push({i});
+  ASSERT_EQ(ring.size(), 3u);
+  EXPECT_EQ(ring[0], std::vector<int>({2}));
+  EXPECT_EQ(ring.back(), std::vector<int>({4}));
+
+  // Slots are recycled as they were left.
+  auto &slot = ring.push();
+  EXPECT_EQ(slot, std::vector<int>({2}));
+  slot.push_back(5);
+  EXPECT_EQ(ring[0], std::vector<int>({3}));
+  EXPECT_EQ(ring[2], std::vector<int>({2, 5}));
+
+  ring.clear();
+  EXPECT_EQ(ring.size(), 0u);
+  EXPECT_EQ(ring.capacity(), 3u);
+}
+
 TEST_F(UtilTest, CooldownTest) {
   Cooldown x{1};
   EXPECT_FALSE(x.cool(0.6));